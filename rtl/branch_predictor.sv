@@ -0,0 +1,210 @@
+//branch prediction in fetch for the five stage core, only instantiated when top is built with PIPELINED
+//the btb holds the target of every branch and jal that has been taken, direct mapped on the PC and tagged with the rest of it
+//a btb hit is predicted taken when the direction predictor says so, always for a jal
+//  SCHEME 0  none, fetch always goes on to PC+4
+//         1  static backward taken forward not taken, from the target in the btb
+//         2  bimodal, a 2-bit saturating counter per PC
+//         3  gshare, the counters are indexed with the PC xor the outcomes of the last GHR_BITS branches
+//the tables and the history are updated when the branch resolves in execute, not speculatively
+//jalr targets depend on a register, fetch predecodes the instruction to predict them
+//  ret (jalr x0, 0(ra))    from the return address stack, which every jal/jalr with rd=ra pushes its PC+4 on in fetch
+//  any other jalr          from the indirect target cache, the last target of that jalr, tagged like the btb
+//the stack pointer travels down the pipeline with each instruction, a redirect from execute restores it to what it was
+//after that instruction, entries a wrong path call overwrote stay wrong until they are pushed again
+module branch_predictor #(
+    parameter DATA_WIDTH = 32,
+    parameter SCHEME = 2,
+    parameter BTB_ENTRIES = 16,     //power of two
+    parameter BHT_ENTRIES = 64,     //power of two
+    parameter GHR_BITS = 6,         //at most log2(BHT_ENTRIES)
+    parameter RAS_ENTRIES = 8,      //power of two, wraps around when it overflows
+    parameter ITC_ENTRIES = 4,      //power of two
+    localparam BTB_BITS = $clog2(BTB_ENTRIES),
+    localparam BHT_BITS = $clog2(BHT_ENTRIES),
+    localparam RAS_BITS = $clog2(RAS_ENTRIES),
+    localparam ITC_BITS = $clog2(ITC_ENTRIES)
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+
+    //lookup, combinational on the fetch PC and instruction
+    input  logic [DATA_WIDTH-1:0]   PCF_i,
+    input  logic [DATA_WIDTH-1:0]   InstrF_i,
+    input  logic                    StallF_i,       //the instruction is fetched again next cycle, don't push/pop for it yet
+    output logic                    PredTakenF_o,
+    output logic [DATA_WIDTH-1:0]   PredTargetF_o,
+    output logic                    PredHitF_o,     //the btb, stack or indirect target cache had a target for it
+    output logic [BHT_BITS-1:0]     BHTIndexF_o,    //carried down to execute so the update hits the counter that predicted
+    output logic [RAS_BITS-1:0]     RasPtrF_o,      //carried down to execute for the recovery
+
+    //update, a branch or jump resolved in execute
+    input  logic                    UpdateE_i,
+    input  logic                    BranchE_i,      //conditional
+    input  logic                    JalrE_i,        //jal when both are low
+    input  logic                    TakenE_i,
+    input  logic [DATA_WIDTH-1:0]   PCE_i,
+    input  logic [DATA_WIDTH-1:0]   TargetE_i,
+    input  logic [BHT_BITS-1:0]     BHTIndexE_i,
+
+    //stack recovery, execute redirected fetch
+    input  logic                    RedirectE_i,
+    input  logic                    CallE_i,
+    input  logic                    RetE_i,
+    input  logic [RAS_BITS-1:0]     RasPtrE_i,
+    input  logic [DATA_WIDTH-1:0]   PCPlus4E_i
+);
+
+localparam TAG_BITS = DATA_WIDTH - BTB_BITS - 2;
+localparam ITC_TAG_BITS = DATA_WIDTH - ITC_BITS - 2;
+
+generate
+    if (SCHEME == 0) begin : none
+        assign PredTakenF_o = 1'b0;
+        assign PredTargetF_o = '0;
+        assign PredHitF_o = 1'b0;
+        assign BHTIndexF_o = '0;
+        assign RasPtrF_o = '0;
+    end
+    else begin : predictor
+        logic                   btb_valid [BTB_ENTRIES];
+        logic [TAG_BITS-1:0]    btb_tag [BTB_ENTRIES];
+        logic [DATA_WIDTH-1:0]  btb_target [BTB_ENTRIES];
+        logic                   btb_jump [BTB_ENTRIES];
+        logic [1:0]             bht [BHT_ENTRIES];
+        logic [GHR_BITS-1:0]    ghr;
+        logic [DATA_WIDTH-1:0]  ras [RAS_ENTRIES];
+        logic [RAS_BITS-1:0]    ras_ptr;
+        logic                   itc_valid [ITC_ENTRIES];
+        logic [ITC_TAG_BITS-1:0] itc_tag [ITC_ENTRIES];
+        logic [DATA_WIDTH-1:0]  itc_target [ITC_ENTRIES];
+
+        logic [BTB_BITS-1:0]    btb_index;
+        logic [BTB_BITS-1:0]    update_index;
+        logic [ITC_BITS-1:0]    itc_index;
+        logic [ITC_BITS-1:0]    itc_update_index;
+        logic                   btb_hit;
+        logic                   itc_hit;
+        logic                   direction;
+
+        //predecode of the fetched instruction
+        logic                   jalF;
+        logic                   jalrF;
+        logic                   callF;
+        logic                   retF;
+
+        assign jalF = (InstrF_i[6:0] == 7'd111);
+        assign jalrF = (InstrF_i[6:0] == 7'd103);
+        assign callF = (jalF || jalrF) && (InstrF_i[11:7] == 5'd1);
+        assign retF = jalrF && (InstrF_i[11:7] == 5'd0) && (InstrF_i[19:15] == 5'd1);
+        assign RasPtrF_o = ras_ptr;
+
+        assign btb_index = PCF_i[BTB_BITS+1:2];
+        assign update_index = PCE_i[BTB_BITS+1:2];
+        assign itc_index = PCF_i[ITC_BITS+1:2];
+        assign itc_update_index = PCE_i[ITC_BITS+1:2];
+
+        if (SCHEME == 3) begin : gshare
+            assign BHTIndexF_o = PCF_i[BHT_BITS+1:2] ^ BHT_BITS'(ghr);
+        end
+        else begin : bimodal
+            assign BHTIndexF_o = PCF_i[BHT_BITS+1:2];
+        end
+
+        always_comb begin
+            if (btb_jump[btb_index])
+                direction = 1'b1;
+            else if (SCHEME == 1)
+                direction = btb_target[btb_index] < PCF_i;
+            else
+                direction = bht[BHTIndexF_o][1];
+        end
+
+        assign btb_hit = btb_valid[btb_index] && (btb_tag[btb_index] == PCF_i[DATA_WIDTH-1:BTB_BITS+2]);
+        assign itc_hit = itc_valid[itc_index] && (itc_tag[itc_index] == PCF_i[DATA_WIDTH-1:ITC_BITS+2]);
+
+        always_comb begin
+            if (retF) begin
+                PredHitF_o = 1'b1;
+                PredTakenF_o = 1'b1;
+                PredTargetF_o = ras[ras_ptr - RAS_BITS'(1)];
+            end
+            else if (jalrF) begin
+                PredHitF_o = itc_hit;
+                PredTakenF_o = itc_hit;
+                PredTargetF_o = itc_target[itc_index];
+            end
+            else begin
+                PredHitF_o = btb_hit;
+                PredTakenF_o = btb_hit && direction;
+                PredTargetF_o = btb_target[btb_index];
+            end
+        end
+
+        //allocate on taken, a not taken branch that hits keeps its entry and trains its counter down
+        always_ff @(posedge clk) begin
+            if (UpdateE_i && TakenE_i && !JalrE_i) begin
+                btb_tag[update_index] <= PCE_i[DATA_WIDTH-1:BTB_BITS+2];
+                btb_target[update_index] <= TargetE_i;
+                btb_jump[update_index] <= !BranchE_i;
+            end
+            if (UpdateE_i && JalrE_i && !RetE_i) begin
+                itc_tag[itc_update_index] <= PCE_i[DATA_WIDTH-1:ITC_BITS+2];
+                itc_target[itc_update_index] <= TargetE_i;
+            end
+            if (RedirectE_i) begin
+                if (CallE_i)
+                    ras[RasPtrE_i] <= PCPlus4E_i;
+            end
+            else if (!StallF_i && callF)
+                ras[ras_ptr] <= PCF_i + 32'd4;
+        end
+
+        //the stack pointer, a redirect replays what the instruction in execute did to it
+        always_ff @(posedge clk or posedge rst) begin
+            if (rst)
+                ras_ptr <= '0;
+            else if (RedirectE_i) begin
+                if (CallE_i)
+                    ras_ptr <= RasPtrE_i + RAS_BITS'(1);
+                else if (RetE_i)
+                    ras_ptr <= RasPtrE_i - RAS_BITS'(1);
+                else
+                    ras_ptr <= RasPtrE_i;
+            end
+            else if (!StallF_i) begin
+                if (callF)
+                    ras_ptr <= ras_ptr + RAS_BITS'(1);
+                else if (retF)
+                    ras_ptr <= ras_ptr - RAS_BITS'(1);
+            end
+        end
+
+        //counters start weakly not taken
+        always_ff @(posedge clk or posedge rst) begin
+            if (rst) begin
+                for (int i = 0; i < BTB_ENTRIES; i++)
+                    btb_valid[i] <= 1'b0;
+                for (int i = 0; i < BHT_ENTRIES; i++)
+                    bht[i] <= 2'b01;
+                for (int i = 0; i < ITC_ENTRIES; i++)
+                    itc_valid[i] <= 1'b0;
+                ghr <= '0;
+            end
+            else if (UpdateE_i) begin
+                if (TakenE_i && !JalrE_i)
+                    btb_valid[update_index] <= 1'b1;
+                if (JalrE_i && !RetE_i)
+                    itc_valid[itc_update_index] <= 1'b1;
+                if (BranchE_i) begin
+                    if (TakenE_i && bht[BHTIndexE_i] != 2'b11)
+                        bht[BHTIndexE_i] <= bht[BHTIndexE_i] + 2'b01;
+                    else if (!TakenE_i && bht[BHTIndexE_i] != 2'b00)
+                        bht[BHTIndexE_i] <= bht[BHTIndexE_i] - 2'b01;
+                    ghr <= GHR_BITS'({ghr, TakenE_i});
+                end
+            end
+        end
+    end
+endgenerate
+
+endmodule
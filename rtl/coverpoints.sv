@@ -0,0 +1,67 @@
+module coverpoints #(
+    parameter DATA_WIDTH = 32
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+    input  logic                    valid_i,    //low for a pipeline bubble, which covers nothing
+    input  logic [DATA_WIDTH-1:0]   Instr_i,
+    input  logic [3:0]              ALUCtrl_i,
+    input  logic [1:0]              MemType_i,
+    input  logic                    MemSign_i,
+    input  logic [DATA_WIDTH-1:0]   addr_i,
+    input  logic                    branchTaken_i
+);
+
+//functional cover points for the coverage build (COVERAGE), instantiated from top
+//one point per decoder arm in controlunit.sv, ALU op in ALU.sv and memory access shape in data_mem_i/o.sv
+//arms the decoder treats as default (illegal funct3 etc) get their own point so holes show up in the report
+
+    logic [6:0]     op;
+    logic [2:0]     funct3;
+    logic           funct7_5;
+
+    assign op = Instr_i[6:0];
+    assign funct3 = Instr_i[14:12];
+    assign funct7_5 = Instr_i[30];
+
+    //every opcode the control unit decodes, plus anything else
+    localparam int NUM_OPS = 9;
+    localparam logic [6:0] OPS [NUM_OPS] = '{7'd3, 7'd19, 7'd23, 7'd35, 7'd51, 7'd55, 7'd99, 7'd103, 7'd111};
+
+    for (genvar i = 0; i < NUM_OPS; i++) begin : opcode
+        c_op: cover property (@(posedge clk) disable iff (rst || !valid_i) op == OPS[i]);
+    end
+
+    c_op_illegal: cover property (@(posedge clk) disable iff (rst || !valid_i)
+        !(op inside {7'd3, 7'd19, 7'd23, 7'd35, 7'd51, 7'd55, 7'd99, 7'd103, 7'd111}));
+
+    //funct3 arms of each decoder case, funct7[5] split for add/sub and srl/sra
+    for (genvar f = 0; f < 8; f++) begin : funct
+        c_load:     cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd3 && funct3 == 3'(f));
+        c_store:    cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd35 && funct3 == 3'(f));
+        c_imm:      cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd19 && funct3 == 3'(f) && !funct7_5);
+        c_imm_f7:   cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd19 && funct3 == 3'(f) && funct7_5);
+        c_reg:      cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd51 && funct3 == 3'(f) && !funct7_5);
+        c_reg_f7:   cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd51 && funct3 == 3'(f) && funct7_5);
+        c_taken:    cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd99 && funct3 == 3'(f) && branchTaken_i);
+        c_nottaken: cover property (@(posedge clk) disable iff (rst || !valid_i) op == 7'd99 && funct3 == 3'(f) && !branchTaken_i);
+    end
+
+    //ALU ops 0000-1001, anything above is the default arm
+    for (genvar a = 0; a < 16; a++) begin : aluctrl
+        c_alu: cover property (@(posedge clk) disable iff (rst || !valid_i) ALUCtrl_i == 4'(a));
+    end
+
+    //mem_type_i x mem_sign_i x byte offset as seen by data_mem_o on loads and data_mem_i on stores
+    for (genvar t = 0; t < 4; t++) begin : mem_type
+        for (genvar o = 0; o < 4; o++) begin : offset
+            c_load_signed:   cover property (@(posedge clk) disable iff (rst || !valid_i)
+                op == 7'd3 && MemType_i == 2'(t) && !MemSign_i && addr_i[1:0] == 2'(o));
+            c_load_unsigned: cover property (@(posedge clk) disable iff (rst || !valid_i)
+                op == 7'd3 && MemType_i == 2'(t) && MemSign_i && addr_i[1:0] == 2'(o));
+            c_store:         cover property (@(posedge clk) disable iff (rst || !valid_i)
+                op == 7'd35 && MemType_i == 2'(t) && addr_i[1:0] == 2'(o));
+        end
+    end
+
+endmodule
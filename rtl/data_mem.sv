@@ -1,7 +1,8 @@
 module data_mem #(
     parameter 
               ADDR_WIDTH = 32, 
-              DATA_WIDTH = 8
+              DATA_WIDTH = 8,
+              MEM_ADDR_BITS = 17    //depth is 2^MEM_ADDR_BITS bytes, at least 17 for data.hex at 0x10000
 ) (
     input  logic                     clk_i,
     input  logic                     write_en_i,
@@ -10,21 +11,26 @@ module data_mem #(
     output logic [ADDR_WIDTH-1:0]    read_data_o
 );
 
-    logic [DATA_WIDTH-1:0] ram_array [17'h1FFFF : 17'h0]; 
+    logic [DATA_WIDTH-1:0] ram_array [2**MEM_ADDR_BITS-1 : 0] /*verilator public*/;
+    logic [MEM_ADDR_BITS-1:0] addr;
+
+    assign addr = addr_i[MEM_ADDR_BITS-1:0];
 
     initial begin 
         $readmemh("data.hex", ram_array, 17'h10000);
         $display ("Loaded data_mem.");
     end;
 
-    assign read_data_o = {ram_array[addr_i[16:0] + 3],ram_array[addr_i[16:0] + 2],ram_array[addr_i[16:0] + 1],ram_array[addr_i[16:0]]};
+    assign read_data_o = {ram_array[addr + 3],ram_array[addr + 2],ram_array[addr + 1],ram_array[addr]};
     
-    always_ff @(negedge clk_i) begin
+    //writes on the rising edge like the regfile and PC, the whole core is posedge only
+    //a store still lands at the end of its cycle so loads after it see the new data
+    always_ff @(posedge clk_i) begin
         if (write_en_i) begin
-            ram_array[addr_i[16:0]] <= write_data_i[7:0];
-            ram_array[addr_i[16:0] + 1] <= write_data_i[15:8];
-            ram_array[addr_i[16:0] + 2] <= write_data_i[23:16];
-            ram_array[addr_i[16:0] + 3] <= write_data_i[31:24];
+            ram_array[addr] <= write_data_i[7:0];
+            ram_array[addr + 1] <= write_data_i[15:8];
+            ram_array[addr + 2] <= write_data_i[23:16];
+            ram_array[addr + 3] <= write_data_i[31:24];
         end
     end 
 
@@ -0,0 +1,56 @@
+//drop-in replacement for data_mem backed by the C++ sparse page model (tb/common/sparse_mem.h)
+//covers the full 32-bit address space, so nothing aliases above 128KB
+//selected in data_mem_top by building with +define+SPARSE_MEM
+
+module data_mem_sparse #(
+    parameter ADDR_WIDTH = 32
+) (
+    input  logic                     clk_i,
+    input  logic                     read_en_i,     //only counts the read in the page statistics
+    input  logic                     write_en_i,
+    input  logic [ADDR_WIDTH-1:0]    addr_i,
+    input  logic [ADDR_WIDTH-1:0]    write_data_i,
+    output logic [ADDR_WIDTH-1:0]    read_data_o
+);
+
+    import "DPI-C" function int unsigned sparse_mem_read(input int unsigned addr, input int unsigned gen);
+    import "DPI-C" function void sparse_mem_count_read(input int unsigned addr);
+    import "DPI-C" function void sparse_mem_write(input int unsigned addr, input int unsigned data);
+    import "DPI-C" function int sparse_mem_load_hex(input string path, input int unsigned base);
+
+    //bumped on every write so the combinational read is re-evaluated
+    //even when the address has not changed
+    logic [31:0] mem_gen;
+
+    initial begin
+        string          data_file;
+        int unsigned    data_base;
+
+        //memory map can be changed at runtime with +data_file=<path> +data_base=<hex>
+        if (!$value$plusargs("data_file=%s", data_file))
+            data_file = "data.hex";
+        if (!$value$plusargs("data_base=%h", data_base))
+            data_base = 32'h10000;
+
+        mem_gen = 32'd0;
+        if (sparse_mem_load_hex(data_file, data_base) >= 0)
+            $display ("Loaded data_mem_sparse.");
+    end;
+
+    //uncounted, always_comb runs on every evaluation and not once per access
+    always_comb begin
+        read_data_o = sparse_mem_read(addr_i, mem_gen);
+    end
+
+    //posedge only like data_mem, the only reader of this port is the instruction doing the store
+    //reads are counted here too, once per cycle a load is on the port
+    always_ff @(posedge clk_i) begin
+        if (write_en_i) begin
+            sparse_mem_write(addr_i, write_data_i);
+            mem_gen <= mem_gen + 32'd1;
+        end
+        else if (read_en_i)
+            sparse_mem_count_read(addr_i);
+    end
+
+endmodule
@@ -1,7 +1,9 @@
 module data_mem_top #(
-    parameter ADDR_WIDTH = 32
+    parameter ADDR_WIDTH = 32,
+    parameter DMEM_ADDR_BITS = 17
               
 ) (
+    input  logic                          read_en_i,    //a load is on the port, only the sparse memory uses it
     input  logic                          write_en_i,
     input  logic                          clk_i,
     input  logic     [1:0]                mem_type_i,
@@ -27,13 +29,27 @@ data_mem_i data_mem_i (
     
 );
 
-data_mem data_mem(
+`ifdef SPARSE_MEM
+//C++ page-allocated backend, see data_mem_sparse.sv
+data_mem_sparse data_mem(
+    .read_en_i(read_en_i),
     .write_en_i(write_en_i),
     .clk_i(clk_i),
     .addr_i(addr_i_i),
     .write_data_i(Write_Data),
     .read_data_o(Read_Data)
 );
+`else
+data_mem #(
+    .MEM_ADDR_BITS(DMEM_ADDR_BITS)
+) data_mem(
+    .write_en_i(write_en_i),
+    .clk_i(clk_i),
+    .addr_i(addr_i_i),
+    .write_data_i(Write_Data),
+    .read_data_o(Read_Data)
+);
+`endif
 
 data_mem_o data_mem_o(
     .mem_type_i(mem_type_i),
@@ -0,0 +1,475 @@
+//data cache between memoryblock and data_mem_top, only instantiated when top is built with DCACHE_BYTES above 0
+//CACHE_BYTES / LINE_BYTES lines in WAYS ways, least recently used replacement, write-back and write-allocate
+//the core side is data_mem_top's, a byte or halfword store merges into the cached word like data_mem_i does
+//a miss first writes the victim back if it is dirty, then refills the line, MEM_LATENCY cycles to the first word
+//and one word a cycle after that for both, stall_o holds the access in memory until it hits
+//with VICTIM_ENTRIES above 0 a small fully associative victim cache catches the lines the sets evict, a lookup that
+//misses the sets but hits it swaps the two lines in one cycle, and only the victim cache's oldest entry is written back
+//prefetch_i asks for the line of prefetch_addr_i (see prefetcher.sv), it's taken in an idle cycle and dropped if the
+//line is already in, otherwise filled like a miss while loads and stores that hit other lines go on, and loads of
+//the words of the line already written read them
+//with MSHRS above 0 a load that misses doesn't hold the core, it takes a miss status holding register with its dest_i
+//and the core goes on without its data (defer_o), the line is filled like a prefetch's, a later load
+//to a line already waiting on its fill takes another MSHR and shares the refill, a load to a further line waits for
+//its own once the current one is through, the loaded word is kept in the MSHR as it goes past and handed back
+//through return_o, pending_o has a bit set for the destination of every deferred load that hasn't returned
+//stores, and loads that find every MSHR taken, still hold the core until they hit
+module dcache #(
+    parameter DATA_WIDTH = 32,
+    parameter CACHE_BYTES = 1024,   //power of two
+    parameter LINE_BYTES = 16,      //power of two, at least 8
+    parameter WAYS = 2,             //power of two, at most CACHE_BYTES / LINE_BYTES
+    parameter MEM_LATENCY = 4,      //cycles from a writeback or refill request to the first word
+    parameter VICTIM_ENTRIES = 0,   //lines in the victim cache, none with 0
+    parameter MSHRS = 0,            //loads that can miss without holding the core, blocking with 0
+    parameter DEST_BITS = 5,        //a load's destination, a register number
+    localparam WORDS = LINE_BYTES / 4,
+    localparam SETS = CACHE_BYTES / (LINE_BYTES * WAYS),
+    localparam OFFSET_BITS = $clog2(LINE_BYTES),
+    localparam WORD_BITS = $clog2(WORDS),
+    localparam INDEX_BITS = $clog2(SETS),
+    localparam SET_BITS = (SETS > 1) ? INDEX_BITS : 1,
+    localparam WAY_BITS = (WAYS > 1) ? $clog2(WAYS) : 1,
+    localparam TAG_BITS = DATA_WIDTH - OFFSET_BITS - INDEX_BITS,
+    localparam LINE_BITS = DATA_WIDTH - OFFSET_BITS,
+    localparam DELAY_BITS = $clog2(MEM_LATENCY + 2),
+    localparam VICTIM_SLOTS = (VICTIM_ENTRIES > 0) ? VICTIM_ENTRIES : 1,
+    localparam VICTIM_BITS = (VICTIM_ENTRIES > 1) ? $clog2(VICTIM_ENTRIES) : 1,
+    localparam MSHR_SLOTS = (MSHRS > 0) ? MSHRS : 1,
+    localparam MSHR_BITS = (MSHRS > 1) ? $clog2(MSHRS) : 1
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+
+    //core side
+    input  logic                    read_en_i,
+    input  logic                    write_en_i,
+    input  logic [1:0]              mem_type_i,
+    input  logic                    mem_sign_i,
+    input  logic [DATA_WIDTH-1:0]   addr_i,
+    input  logic [DATA_WIDTH-1:0]   write_data_i,
+    output logic [DATA_WIDTH-1:0]   read_data_o,
+    output logic                    stall_o,        //the access waits on a writeback or refill
+    output logic                    miss_o,         //high in the cycle a miss is found
+    output logic                    writeback_o,    //and it evicts a dirty line
+    output logic                    victim_hit_o,   //high in the cycle the victim cache saves a miss
+
+    //prefetches
+    input  logic                    prefetch_i,
+    input  logic [DATA_WIDTH-1:0]   prefetch_addr_i,
+    output logic                    prefetch_ack_o, //the request is taken, filled or dropped
+    output logic                    prefetch_o,     //high in the cycle a prefetch starts
+    output logic                    prefetch_hit_o, //an access hit a prefetched line for the first time
+
+    //deferred loads
+    input  logic [DEST_BITS-1:0]    dest_i,
+    output logic                    defer_o,        //the load missed and took an MSHR, read_data_o isn't its data
+    output logic [2**DEST_BITS-1:0] pending_o,
+    output logic                    outstanding_o,  //an MSHR is in use
+    input  logic                    cancel_i,       //a younger instruction wrote cancel_dest_i, its deferred load is dropped
+    input  logic [DEST_BITS-1:0]    cancel_dest_i,
+    output logic                    return_o,       //a deferred load's data, held until return_ack_i
+    output logic [DEST_BITS-1:0]    return_dest_o,
+    output logic [DATA_WIDTH-1:0]   return_data_o,
+    input  logic                    return_ack_i,
+
+    //backing memory, word accesses one at a time
+    output logic [DATA_WIDTH-1:0]   mem_addr_o,
+    output logic                    mem_read_o,
+    output logic                    mem_write_o,
+    output logic [DATA_WIDTH-1:0]   mem_write_data_o,
+    input  logic [DATA_WIDTH-1:0]   mem_read_data_i
+);
+
+localparam [1:0] IDLE = 2'd0;
+localparam [1:0] WRITEBACK = 2'd1;
+localparam [1:0] REFILL = 2'd2;
+
+//public for the backdoor, which reads dirty lines from here rather than data_mem
+logic                   valid [WAYS][SETS] /*verilator public*/;
+logic                   dirty [WAYS][SETS] /*verilator public*/;
+logic [TAG_BITS-1:0]    tags [WAYS][SETS] /*verilator public*/;
+logic [DATA_WIDTH-1:0]  lines [WAYS][SETS][WORDS] /*verilator public*/;
+logic [WAY_BITS-1:0]    age [WAYS][SETS];           //0 is the most recently used way of a set
+logic                   prefetched [WAYS][SETS];    //filled by a prefetch and not accessed since
+
+//victim cache, tagged with the whole line address and replaced round robin
+logic                   victim_valid [VICTIM_SLOTS] /*verilator public*/;
+logic                   victim_dirty [VICTIM_SLOTS] /*verilator public*/;
+logic [LINE_BITS-1:0]   victim_tags [VICTIM_SLOTS] /*verilator public*/;
+logic [DATA_WIDTH-1:0]  victim_lines [VICTIM_SLOTS][WORDS] /*verilator public*/;
+logic [VICTIM_BITS-1:0] victim_next;
+
+//MSHRs, one deferred load each, ready once its word went past in a refill
+logic                   mshr_valid [MSHR_SLOTS];
+logic                   mshr_ready [MSHR_SLOTS];
+logic [DATA_WIDTH-1:0]  mshr_addr [MSHR_SLOTS];
+logic [1:0]             mshr_type [MSHR_SLOTS];
+logic                   mshr_sign [MSHR_SLOTS];
+logic [DEST_BITS-1:0]   mshr_dest [MSHR_SLOTS];
+logic [DATA_WIDTH-1:0]  mshr_data [MSHR_SLOTS];
+logic                   mshr_capture [MSHR_SLOTS];     //its word is on mem_read_data_i
+
+logic [SET_BITS-1:0]    set;
+logic [TAG_BITS-1:0]    tag;
+logic [WORD_BITS-1:0]   word;
+logic                   access;
+logic                   lookup_hit;
+logic                   hit;
+logic [WAY_BITS-1:0]    hit_way;
+logic [DATA_WIDTH-1:0]  hit_data;
+logic [DATA_WIDTH-1:0]  store_data;
+logic [WAY_BITS-1:0]    victim;
+logic                   lookup_miss;
+logic                   victim_lookup;
+logic [VICTIM_BITS-1:0] victim_entry;
+logic                   core_miss;
+
+//the free MSHR a deferred load takes, the waiting one filled next and the one returning
+logic                   mshr_free;
+logic [MSHR_BITS-1:0]   mshr_slot;
+logic                   queued;
+logic [MSHR_BITS-1:0]   queued_entry;
+logic [MSHR_BITS-1:0]   return_entry;
+logic                   arrived;        //the access's word already went past in the refill
+logic                   filled;         //and it is a load that can read it from the line being filled
+logic [WAY_BITS-1:0]    read_way;
+
+//a prefetch's lookup, and the set and line a miss, waiting MSHR or prefetch fills
+logic [SET_BITS-1:0]    prefetch_set;
+logic                   prefetch_present;
+logic                   queued_start;
+logic                   start;
+logic [LINE_BITS-1:0]   start_line;
+logic [SET_BITS-1:0]    start_set;
+logic                   start_writeback;
+
+//the line a set gives up, the victim on a miss and the filled way once the victim cache's entry is written back
+logic                   evict;
+logic [WAY_BITS-1:0]    evict_way;
+logic [SET_BITS-1:0]    evict_set;
+logic [LINE_BITS-1:0]   evict_line;
+
+//miss handling, the line being filled, the one being written back and how far it got
+logic [1:0]             state;
+logic                   background;     //the fill doesn't hold the core, hits to other lines go on
+logic                   prefetching;    //and it is a prefetch
+logic [DELAY_BITS-1:0]  delay;
+logic [LINE_BITS-1:0]   fill_line;
+logic [LINE_BITS-1:0]   wb_line;
+logic [WAY_BITS-1:0]    fill_way;
+logic [WORD_BITS-1:0]   fill_word;
+logic [SET_BITS-1:0]    fill_set;
+logic                   word_en;
+logic                   last_word;
+
+assign set = SET_BITS'(addr_i >> OFFSET_BITS) & SET_BITS'(SETS - 1);
+assign tag = TAG_BITS'(addr_i >> (OFFSET_BITS + INDEX_BITS));
+assign word = addr_i[OFFSET_BITS-1:2];
+assign access = read_en_i || write_en_i;
+
+always_comb begin
+    lookup_hit = 1'b0;
+    hit_way = '0;
+    for (int way = 0; way < WAYS; way++) begin
+        if (valid[way][set] && (tags[way][set] == tag)) begin
+            lookup_hit = 1'b1;
+            hit_way = WAY_BITS'(way);
+        end
+    end
+end
+
+assign read_way = filled ? fill_way : hit_way;
+assign hit_data = lines[read_way][set][word];
+
+assign prefetch_set = SET_BITS'(prefetch_addr_i >> OFFSET_BITS) & SET_BITS'(SETS - 1);
+
+always_comb begin
+    prefetch_present = 1'b0;
+    for (int way = 0; way < WAYS; way++)
+        if (valid[way][prefetch_set] && (tags[way][prefetch_set] == TAG_BITS'(prefetch_addr_i >> (OFFSET_BITS + INDEX_BITS))))
+            prefetch_present = 1'b1;
+    for (int i = 0; i < VICTIM_ENTRIES; i++)
+        if (victim_valid[i] && (victim_tags[i] == prefetch_addr_i[DATA_WIDTH-1:OFFSET_BITS]))
+            prefetch_present = 1'b1;
+end
+
+//an empty way if the set has one, the least recently used otherwise
+always_comb begin
+    victim = '0;
+    for (int way = 0; way < WAYS; way++)
+        if (age[way][start_set] == WAY_BITS'(WAYS - 1))
+            victim = WAY_BITS'(way);
+    for (int way = WAYS - 1; way >= 0; way--)
+        if (!valid[way][start_set])
+            victim = WAY_BITS'(way);
+end
+
+always_comb begin
+    victim_lookup = 1'b0;
+    victim_entry = '0;
+    for (int i = 0; i < VICTIM_ENTRIES; i++) begin
+        if (victim_valid[i] && (victim_tags[i] == addr_i[DATA_WIDTH-1:OFFSET_BITS])) begin
+            victim_lookup = 1'b1;
+            victim_entry = VICTIM_BITS'(i);
+        end
+    end
+end
+
+always_comb begin
+    mshr_free = 1'b0;
+    mshr_slot = '0;
+    queued = 1'b0;
+    queued_entry = '0;
+    return_o = 1'b0;
+    return_entry = '0;
+    outstanding_o = 1'b0;
+    pending_o = '0;
+    for (int i = MSHRS - 1; i >= 0; i--) begin
+        if (!mshr_valid[i]) begin
+            mshr_free = 1'b1;
+            mshr_slot = MSHR_BITS'(i);
+        end
+        if (mshr_valid[i] && !mshr_ready[i]) begin
+            queued = 1'b1;
+            queued_entry = MSHR_BITS'(i);
+        end
+        if (mshr_valid[i] && mshr_ready[i]) begin
+            return_o = 1'b1;
+            return_entry = MSHR_BITS'(i);
+        end
+        if (mshr_valid[i]) begin
+            outstanding_o = 1'b1;
+            pending_o[mshr_dest[i]] = 1'b1;
+        end
+    end
+end
+
+always_comb begin
+    for (int i = 0; i < MSHR_SLOTS; i++)
+        mshr_capture[i] = mshr_valid[i] && !mshr_ready[i] && (state == REFILL) && word_en
+                       && (mshr_addr[i][DATA_WIDTH-1:2] == {fill_line, fill_word});
+end
+
+assign return_dest_o = mshr_dest[return_entry];
+
+//the returning load's bytes out of its word
+data_mem_o return_data(
+    .mem_type_i(mshr_type[return_entry]),
+    .mem_sign_i(mshr_sign[return_entry]),
+    .addr_i(mshr_addr[return_entry]),
+    .read_data_i(mshr_data[return_entry]),
+    .read_data_o(return_data_o)
+);
+
+//during a fill that doesn't hold the core everything but the line it replaces can hit, a load of a word of that line
+//already written reads it, and a load that misses takes an MSHR unless its word is going past right now (it waits a
+//cycle) or the victim cache has it (it waits for the swap)
+assign hit = lookup_hit && ((state == IDLE) || (background && !((hit_way == fill_way) && (set == fill_set))));
+assign arrived = (state == REFILL) && (addr_i[DATA_WIDTH-1:OFFSET_BITS] == fill_line)
+              && ((fill_word > word) || ((fill_word == word) && word_en));
+assign filled = background && read_en_i && arrived && (fill_word > word);
+assign defer_o = (MSHRS > 0) && read_en_i && !lookup_hit && !victim_lookup && mshr_free
+              && ((state == IDLE) || (background && !arrived));
+assign stall_o = access && !hit && !filled && !defer_o;
+assign lookup_miss = (state == IDLE) && access && !lookup_hit;
+assign victim_hit_o = lookup_miss && victim_lookup;
+assign core_miss = lookup_miss && !victim_lookup;
+assign miss_o = core_miss || defer_o;
+
+//a waiting MSHR and a prefetch are taken in a cycle without a load or store, so their victim isn't the line one just hit
+//any load or store selects its own set, a victim cache hit swaps with the victim of that set without starting a fill
+assign queued_start = (state == IDLE) && !access && queued;
+assign prefetch_ack_o = prefetch_i && (state == IDLE) && !access && !queued;
+assign prefetch_o = prefetch_ack_o && !prefetch_present;
+assign start = core_miss || queued_start || prefetch_o;
+assign start_line = access ? addr_i[DATA_WIDTH-1:OFFSET_BITS]
+                  : queued ? mshr_addr[queued_entry][DATA_WIDTH-1:OFFSET_BITS]
+                  : prefetch_addr_i[DATA_WIDTH-1:OFFSET_BITS];
+assign start_set = SET_BITS'(start_line) & SET_BITS'(SETS - 1);
+assign writeback_o = start && start_writeback;
+
+//without a victim cache the set's victim is written back, with one the entry it replaces, and only a valid line
+//moves there, an empty way leaves the entry alone
+generate
+    if (VICTIM_ENTRIES > 0) begin : victim_cache
+        assign start_writeback = valid[victim][start_set] && victim_valid[victim_next] && victim_dirty[victim_next];
+        assign evict = ((start && !start_writeback) || ((state == WRITEBACK) && last_word)) && valid[evict_way][evict_set];
+    end
+    else begin : no_victim_cache
+        assign start_writeback = valid[victim][start_set] && dirty[victim][start_set];
+        assign evict = 1'b0;
+    end
+endgenerate
+
+assign prefetch_hit_o = hit && prefetched[hit_way][set];
+
+assign evict_way = (state == IDLE) ? victim : fill_way;
+assign evict_set = (state == IDLE) ? start_set : fill_set;
+assign evict_line = (LINE_BITS'(tags[evict_way][evict_set]) << INDEX_BITS) | LINE_BITS'(evict_set);
+
+//sub-word stores and loads, on the cached word
+data_mem_i data_mem_i (
+    .mem_type_i(mem_type_i),
+    .addr_i(addr_i),
+    .read_data_i(hit_data),
+    .write_data_i(write_data_i),
+    .write_data_o(store_data)
+);
+
+data_mem_o data_mem_o(
+    .mem_type_i(mem_type_i),
+    .mem_sign_i(mem_sign_i),
+    .addr_i(addr_i),
+    .read_data_i(hit_data),
+    .read_data_o(read_data_o)
+);
+
+assign fill_set = SET_BITS'(fill_line) & SET_BITS'(SETS - 1);
+assign word_en = (state != IDLE) && (delay == '0);
+assign last_word = word_en && (fill_word == WORD_BITS'(WORDS - 1));
+assign mem_addr_o = {(state == WRITEBACK) ? wb_line : fill_line, fill_word, 2'b00};
+assign mem_read_o = (state == REFILL) && word_en;
+assign mem_write_o = (state == WRITEBACK) && word_en;
+assign mem_write_data_o = (VICTIM_ENTRIES > 0) ? victim_lines[victim_next][fill_word] : lines[fill_way][fill_set][fill_word];
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst) begin
+        for (int way = 0; way < WAYS; way++) begin
+            for (int i = 0; i < SETS; i++) begin
+                valid[way][i] <= 1'b0;
+                dirty[way][i] <= 1'b0;
+                prefetched[way][i] <= 1'b0;
+                age[way][i] <= WAY_BITS'(way);
+            end
+        end
+        for (int i = 0; i < VICTIM_SLOTS; i++) begin
+            victim_valid[i] <= 1'b0;
+            victim_dirty[i] <= 1'b0;
+        end
+        victim_next <= '0;
+        for (int i = 0; i < MSHR_SLOTS; i++) begin
+            mshr_valid[i] <= 1'b0;
+            mshr_ready[i] <= 1'b0;
+        end
+        state <= IDLE;
+        background <= 1'b0;
+        prefetching <= 1'b0;
+        delay <= '0;
+        fill_line <= '0;
+        wb_line <= '0;
+        fill_way <= '0;
+        fill_word <= '0;
+    end
+    else begin
+        case (state)
+            IDLE: begin
+                if (start) begin
+                    state <= start_writeback ? WRITEBACK : REFILL;
+                    background <= !core_miss || defer_o;
+                    prefetching <= !core_miss && !queued_start;
+                    delay <= DELAY_BITS'(MEM_LATENCY);
+                    fill_line <= start_line;
+                    wb_line <= (VICTIM_ENTRIES > 0) ? victim_tags[victim_next] : evict_line;
+                    fill_way <= victim;
+                    fill_word <= '0;
+                end
+                else if (victim_hit_o) begin
+                    valid[victim][set] <= 1'b1;
+                    dirty[victim][set] <= victim_dirty[victim_entry];
+                    prefetched[victim][set] <= 1'b0;
+                    victim_valid[victim_entry] <= valid[victim][set];
+                    victim_dirty[victim_entry] <= dirty[victim][set];
+                end
+            end
+            WRITEBACK: begin
+                if (delay != '0)
+                    delay <= delay - DELAY_BITS'(1);
+                else
+                    fill_word <= fill_word + WORD_BITS'(1);
+                if (last_word) begin
+                    state <= REFILL;
+                    delay <= DELAY_BITS'(MEM_LATENCY);
+                end
+            end
+            REFILL: begin
+                if (delay != '0)
+                    delay <= delay - DELAY_BITS'(1);
+                else
+                    fill_word <= fill_word + WORD_BITS'(1);
+                if (last_word) begin
+                    state <= IDLE;
+                    background <= 1'b0;
+                    prefetching <= 1'b0;
+                    valid[fill_way][fill_set] <= 1'b1;
+                    dirty[fill_way][fill_set] <= 1'b0;
+                    prefetched[fill_way][fill_set] <= prefetching;
+                end
+            end
+            default: state <= IDLE;
+        endcase
+        //a hit makes its way the most recently used of the set, in any state
+        if (hit) begin
+            if (write_en_i)
+                dirty[hit_way][set] <= 1'b1;
+            prefetched[hit_way][set] <= 1'b0;
+            for (int way = 0; way < WAYS; way++)
+                if (age[way][set] < age[hit_way][set])
+                    age[way][set] <= age[way][set] + WAY_BITS'(1);
+            age[hit_way][set] <= '0;
+        end
+        //the refill is about to overwrite the set's line, it moves to the victim cache first
+        if (evict) begin
+            victim_valid[victim_next] <= 1'b1;
+            victim_dirty[victim_next] <= dirty[evict_way][evict_set];
+            victim_next <= (victim_next == VICTIM_BITS'(VICTIM_ENTRIES - 1)) ? '0 : victim_next + VICTIM_BITS'(1);
+        end
+        //an MSHR is ready once its word went past and free once returned, or dropped when a younger write or deferred
+        //load to the same destination beat it
+        for (int i = 0; i < MSHRS; i++) begin
+            if (mshr_capture[i])
+                mshr_ready[i] <= 1'b1;
+            if (mshr_valid[i] && ((cancel_i && (mshr_dest[i] == cancel_dest_i)) || (defer_o && (mshr_dest[i] == dest_i))))
+                mshr_valid[i] <= 1'b0;
+        end
+        if (return_o && return_ack_i)
+            mshr_valid[return_entry] <= 1'b0;
+        if (defer_o) begin
+            mshr_valid[mshr_slot] <= 1'b1;
+            mshr_ready[mshr_slot] <= 1'b0;
+        end
+    end
+end
+
+always_ff @(posedge clk) begin
+    if (hit && write_en_i)
+        lines[hit_way][set][word] <= store_data;
+    if ((state == REFILL) && word_en)
+        lines[fill_way][fill_set][fill_word] <= mem_read_data_i;
+    if ((state == REFILL) && last_word)
+        tags[fill_way][fill_set] <= TAG_BITS'(fill_line >> INDEX_BITS);
+    if (victim_hit_o) begin
+        tags[victim][set] <= tag;
+        victim_tags[victim_entry] <= evict_line;
+        for (int i = 0; i < WORDS; i++) begin
+            lines[victim][set][i] <= victim_lines[victim_entry][i];
+            victim_lines[victim_entry][i] <= lines[victim][set][i];
+        end
+    end
+    if (evict) begin
+        victim_tags[victim_next] <= evict_line;
+        for (int i = 0; i < WORDS; i++)
+            victim_lines[victim_next][i] <= lines[evict_way][evict_set][i];
+    end
+    for (int i = 0; i < MSHRS; i++)
+        if (mshr_capture[i])
+            mshr_data[i] <= mem_read_data_i;
+    if (defer_o) begin
+        mshr_addr[mshr_slot] <= addr_i;
+        mshr_type[mshr_slot] <= mem_type_i;
+        mshr_sign[mshr_slot] <= mem_sign_i;
+        mshr_dest[mshr_slot] <= dest_i;
+    end
+end
+
+endmodule
@@ -3,17 +3,12 @@ module decode #(
 ) (
     
     input logic [2:0] ImmSrc_i,
-    
-    //PC related inputs
-    input logic [DATA_WIDTH-1:0] PC_Plus4_F_i,
-    input logic [DATA_WIDTH-1:0] PC_F_i,
 
     input logic clk,
 
     //Register File inputs 
     input logic [4:0] A1_i,
     input logic [4:0] A2_i,
-    input logic [4:0] RdF_i,
     input logic [4:0] RdW_i,
     input logic [DATA_WIDTH-1:0] instr_i,
     input logic [DATA_WIDTH-1:0] WD3_i,
@@ -26,14 +21,8 @@ module decode #(
     //Extend output
     output logic [DATA_WIDTH-1:0] ImmExtD_o,
 
-    //PC related outputs 
-    output logic [DATA_WIDTH-1:0] PC_Plus4D_o, //this is the next instruction 
-    output logic [DATA_WIDTH-1:0] PCD_o, //this goes to execute where it is added to the Immediate for JMP
-    
     //test output 
-    output logic [DATA_WIDTH-1:0] a0_o,
-    output logic [4:0] RdD_o //new output we need
-
+    output logic [DATA_WIDTH-1:0] a0_o
 );
     
 
@@ -61,8 +50,4 @@ module decode #(
         .a0_o(a0_o)
     );
 
-    assign PCD_o = PC_F_i;
-    assign PC_Plus4D_o = PC_Plus4_F_i;
-    assign RdD_o = RdF_i;
-    
 endmodule
@@ -5,19 +5,15 @@ module execute #(
     input logic [DATA_WIDTH-1:0]    RD2E_i,
     input logic [DATA_WIDTH-1:0]    PCE_i,
     input logic [DATA_WIDTH-1:0]    ImmExtE_i,
-    input logic [DATA_WIDTH-1:0]    PCPlus4E_i,
     input logic [3:0]               ALUCtrl_i,
     input logic                     ALUSrcB_i,
     input logic                     ALUSrcA_i,
     input logic                     JumpCtrl_i,  //This deals with the jump instruction 
-    input logic [4:0]               RdD_i,
     input logic [2:0]               BranchSrc_i, //controls branching MUX
 
     output logic [DATA_WIDTH-1:0]   ALUResultE_o,
     output logic [DATA_WIDTH-1:0]   WriteDataE_o,
-    output logic [DATA_WIDTH-1:0]   PCPlus4E_o,
     output logic [DATA_WIDTH-1:0]   PCTargetE_o,
-    output logic [4:0]              RdE_o,
     output logic                    branchTaken_o
 );
 
@@ -44,12 +40,10 @@ ALU ALU(
 //output logic
 logic [DATA_WIDTH-1:0] PCTargetE;
 always_comb begin
-    PCPlus4E_o = PCPlus4E_i;
     PCTargetE = ImmExtE_i + PCE_i;
     WriteDataE_o = RD2E_i;
 end
 
 assign PCTargetE_o = (JumpCtrl_i) ? ALUResultE_o : PCTargetE; //mux for jump instruction (switched order when debugging)
-assign RdE_o = RdD_i;
 
 endmodule
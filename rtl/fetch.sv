@@ -1,14 +1,25 @@
 module fetch #(
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    parameter IMEM_ADDR_BITS = 12,
+    //instruction cache, none with ICACHE_BYTES 0 (see icache.sv)
+    parameter ICACHE_BYTES = 0,
+    parameter ICACHE_LINE_BYTES = 16,
+    parameter ICACHE_WAYS = 1,
+    parameter IMEM_LATENCY = 4
 ) (
     input logic PCSrc_i,
+    input logic StallF_i, //holds the PC, always low in the single cycle core
     input logic clk,
     input logic rst,
     input logic [DATA_WIDTH-1:0] PCTargetE_i, //this is the jump PC value coming after Execute
+    input logic PredTaken_i, //branch predictor guess for the instruction being fetched, low in the single cycle core
+    input logic [DATA_WIDTH-1:0] PredTarget_i,
 
     output logic [DATA_WIDTH-1:0] PC_Plus4_F, //this is the next instruction 
     output logic [DATA_WIDTH-1:0] PC_F, //this goes to execute where it is added to the Immediate for JMP
     output logic [DATA_WIDTH-1:0] Instr_o, //this goes into control unit and EXT
+    output logic Ready_o, //low while the cache refills, Instr_o is zero then and the PC holds
+    output logic IMiss_o, //an instruction cache refill starts
 
     //this goes into REGFILE
     output logic [4:0] A1_o,
@@ -16,7 +27,9 @@ module fetch #(
     output logic [4:0] A3_o
 );
 
-logic [DATA_WIDTH-1:0]  PC;
+logic [DATA_WIDTH-1:0]  PC /*verilator public*/;
+logic [DATA_WIDTH-1:0]  mem_addr;
+logic [DATA_WIDTH-1:0]  mem_data;
 
 pc_module #(
         .DATA_WIDTH(DATA_WIDTH)
@@ -24,19 +37,52 @@ pc_module #(
         .clk(clk),
         .rst(rst),
         .PCsrc(PCSrc_i),
+        .en_i(!StallF_i && (Ready_o || PCSrc_i)),
         .PCTargetE_i(PCTargetE_i),
+        .PredTaken_i(PredTaken_i),
+        .PredTarget_i(PredTarget_i),
 
         .PC(PC),
         .PC_Plus4(PC_Plus4_F)
     );
 
-instrmem instruction_memory (
-    .addr_i(PC),
+instrmem #(
+        .MEM_ADDR_BITS(IMEM_ADDR_BITS)
+    ) instruction_memory (
+    .addr_i(mem_addr),
     
-    .read_data_o(Instr_o)
+    .read_data_o(mem_data)
 );
 
-assign A1_o = Instr_o[19:15];
+generate
+    if (ICACHE_BYTES > 0) begin : cache
+        icache #(
+            .DATA_WIDTH(DATA_WIDTH),
+            .CACHE_BYTES(ICACHE_BYTES),
+            .LINE_BYTES(ICACHE_LINE_BYTES),
+            .WAYS(ICACHE_WAYS),
+            .MEM_LATENCY(IMEM_LATENCY)
+        ) icache (
+            .clk(clk),
+            .rst(rst),
+            .addr_i(PC),
+            .instr_o(Instr_o),
+            .hit_o(Ready_o),
+            .miss_o(IMiss_o),
+            .mem_addr_o(mem_addr),
+            .mem_data_i(mem_data)
+        );
+    end
+    else begin : no_cache
+        assign mem_addr = PC;
+        assign Instr_o = mem_data;
+        assign Ready_o = 1'b1;
+        assign IMiss_o = 1'b0;
+    end
+endgenerate
+
+//LUI has no rs1, those bits are immediate so read x0 to get 0 + imm out of the ALU
+assign A1_o = (Instr_o[6:0] == 7'd55) ? 5'b0 : Instr_o[19:15];
 assign A2_o = Instr_o [24:20];
 assign A3_o = Instr_o [11:7];
 
@@ -0,0 +1,68 @@
+//hazards of the five stage pipeline, only instantiated when top is built with PIPELINED
+//  forwarding   an ALU operand in execute comes from memory (ForwardE 2'b10) or writeback (2'b01) when they write its register
+//               decode reads the register file after writeback has written it (ForwardD), the file only updates at the edge
+//  load use     a load in execute whose result decode needs stalls fetch and decode for one cycle and sends a bubble down
+//  redirect     a mispredicted branch or jump resolves in execute, the two younger instructions in decode and execute are flushed
+//  data cache   a load/store in memory waiting on a miss holds every stage, nothing is flushed until it is through
+//  deferred     a load miss the data cache went on without (DCACHE_MSHRS) stalls decode like load use while decode reads
+//               its register, until the data is back in the register file, unless a redirect flushes decode anyway
+//register numbers are compared as fields, so an instruction without rs2 can stall on the immediate bits there
+module hazard_unit (
+    input  logic [4:0]  Rs1D_i,
+    input  logic [4:0]  Rs2D_i,
+    input  logic [4:0]  Rs1E_i,
+    input  logic [4:0]  Rs2E_i,
+    input  logic [4:0]  RdE_i,
+    input  logic [4:0]  RdM_i,
+    input  logic [4:0]  RdW_i,
+    input  logic        LoadE_i,
+    input  logic        RegWriteM_i,
+    input  logic        RegWriteW_i,
+    input  logic        RedirectE_i,
+    input  logic        MemStallM_i,
+    input  logic        PendingD_i,     //decode reads the register of a deferred load
+
+    output logic [1:0]  ForwardAE_o,
+    output logic [1:0]  ForwardBE_o,
+    output logic        ForwardAD_o,
+    output logic        ForwardBD_o,
+    output logic        StallF_o,
+    output logic        StallD_o,
+    output logic        FlushD_o,
+    output logic        FlushE_o
+);
+
+logic lwStall;
+logic decodeStall;
+
+always_comb begin
+    if (RegWriteM_i && (RdM_i != 5'b0) && (RdM_i == Rs1E_i))
+        ForwardAE_o = 2'b10;
+    else if (RegWriteW_i && (RdW_i != 5'b0) && (RdW_i == Rs1E_i))
+        ForwardAE_o = 2'b01;
+    else
+        ForwardAE_o = 2'b00;
+
+    if (RegWriteM_i && (RdM_i != 5'b0) && (RdM_i == Rs2E_i))
+        ForwardBE_o = 2'b10;
+    else if (RegWriteW_i && (RdW_i != 5'b0) && (RdW_i == Rs2E_i))
+        ForwardBE_o = 2'b01;
+    else
+        ForwardBE_o = 2'b00;
+end
+
+assign ForwardAD_o = RegWriteW_i && (RdW_i != 5'b0) && (RdW_i == Rs1D_i);
+assign ForwardBD_o = RegWriteW_i && (RdW_i != 5'b0) && (RdW_i == Rs2D_i);
+
+assign lwStall = LoadE_i && (RdE_i != 5'b0) && ((RdE_i == Rs1D_i) || (RdE_i == Rs2D_i));
+
+//a load in execute can't be a redirecting branch, but decode can wait on a deferred load behind one, and holding
+//fetch then would drop the redirect's PC
+assign decodeStall = lwStall || (PendingD_i && !RedirectE_i);
+
+assign StallF_o = decodeStall || MemStallM_i;
+assign StallD_o = decodeStall || MemStallM_i;
+assign FlushD_o = RedirectE_i && !MemStallM_i;
+assign FlushE_o = (decodeStall || RedirectE_i) && !MemStallM_i;
+
+endmodule
@@ -0,0 +1,123 @@
+//instruction cache between fetch and instrmem, only instantiated when top is built with ICACHE_BYTES above 0
+//CACHE_BYTES / LINE_BYTES lines in WAYS ways, direct mapped with WAYS 1, a set replaces its ways round robin
+//a miss refills the whole line from the backing memory, MEM_LATENCY cycles to the first word then one word a cycle,
+//hit_o stays low until the line is in and fetch holds its PC meanwhile, so a miss costs MEM_LATENCY + LINE_BYTES/4 + 1 cycles
+//a refill always completes, the PC fetch was redirected to during it is looked up afterwards
+module icache #(
+    parameter DATA_WIDTH = 32,
+    parameter CACHE_BYTES = 1024,   //power of two
+    parameter LINE_BYTES = 16,      //power of two, at least 8
+    parameter WAYS = 1,             //power of two, at most CACHE_BYTES / LINE_BYTES
+    parameter MEM_LATENCY = 4,      //cycles from a refill request to the first word
+    localparam WORDS = LINE_BYTES / 4,
+    localparam SETS = CACHE_BYTES / (LINE_BYTES * WAYS),
+    localparam OFFSET_BITS = $clog2(LINE_BYTES),
+    localparam WORD_BITS = $clog2(WORDS),
+    localparam INDEX_BITS = $clog2(SETS),
+    localparam SET_BITS = (SETS > 1) ? INDEX_BITS : 1,
+    localparam WAY_BITS = (WAYS > 1) ? $clog2(WAYS) : 1,
+    localparam TAG_BITS = DATA_WIDTH - OFFSET_BITS - INDEX_BITS,
+    localparam LINE_BITS = DATA_WIDTH - OFFSET_BITS,
+    localparam DELAY_BITS = $clog2(MEM_LATENCY + 2)
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+
+    //lookup, combinational on the fetch PC
+    input  logic [DATA_WIDTH-1:0]   addr_i,
+    output logic [DATA_WIDTH-1:0]   instr_o,    //zero while hit_o is low, which decodes as a bubble
+    output logic                    hit_o,
+    output logic                    miss_o,     //high in the cycle a refill starts
+
+    //backing memory, read a word at a time
+    output logic [DATA_WIDTH-1:0]   mem_addr_o,
+    input  logic [DATA_WIDTH-1:0]   mem_data_i
+);
+
+//valid is public so the backdoor can tell top was built with the cache
+logic                   valid [WAYS][SETS] /*verilator public*/;
+logic [TAG_BITS-1:0]    tags [WAYS][SETS];
+logic [DATA_WIDTH-1:0]  lines [WAYS][SETS][WORDS];
+logic [WAY_BITS-1:0]    victim [SETS];
+
+logic [SET_BITS-1:0]    set;
+logic [TAG_BITS-1:0]    tag;
+logic [WORD_BITS-1:0]   word;
+logic                   lookup_hit;
+logic [DATA_WIDTH-1:0]  lookup_data;
+
+//refill state, the line being filled and how far it got
+logic                   refilling;
+logic [DELAY_BITS-1:0]  delay;
+logic [LINE_BITS-1:0]   fill_line;
+logic [WAY_BITS-1:0]    fill_way;
+logic [WORD_BITS-1:0]   fill_word;
+logic [SET_BITS-1:0]    fill_set;
+logic                   fill_en;
+logic                   fill_last;
+
+assign set = SET_BITS'(addr_i >> OFFSET_BITS) & SET_BITS'(SETS - 1);
+assign tag = TAG_BITS'(addr_i >> (OFFSET_BITS + INDEX_BITS));
+assign word = addr_i[OFFSET_BITS-1:2];
+
+always_comb begin
+    lookup_hit = 1'b0;
+    lookup_data = '0;
+    for (int way = 0; way < WAYS; way++) begin
+        if (valid[way][set] && (tags[way][set] == tag)) begin
+            lookup_hit = 1'b1;
+            lookup_data = lines[way][set][word];
+        end
+    end
+end
+
+assign hit_o = !refilling && lookup_hit;
+assign miss_o = !refilling && !lookup_hit;
+assign instr_o = hit_o ? lookup_data : '0;
+
+assign fill_set = SET_BITS'(fill_line) & SET_BITS'(SETS - 1);
+assign fill_en = refilling && (delay == '0);
+assign fill_last = fill_en && (fill_word == WORD_BITS'(WORDS - 1));
+assign mem_addr_o = {fill_line, fill_word, 2'b00};
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst) begin
+        for (int way = 0; way < WAYS; way++)
+            for (int i = 0; i < SETS; i++)
+                valid[way][i] <= 1'b0;
+        for (int i = 0; i < SETS; i++)
+            victim[i] <= '0;
+        refilling <= 1'b0;
+        delay <= '0;
+        fill_line <= '0;
+        fill_way <= '0;
+        fill_word <= '0;
+    end
+    else if (refilling) begin
+        if (delay != '0)
+            delay <= delay - DELAY_BITS'(1);
+        else
+            fill_word <= fill_word + WORD_BITS'(1);
+        if (fill_last) begin
+            refilling <= 1'b0;
+            valid[fill_way][fill_set] <= 1'b1;
+            victim[fill_set] <= (fill_way == WAY_BITS'(WAYS - 1)) ? '0 : fill_way + WAY_BITS'(1);
+        end
+    end
+    else if (miss_o) begin
+        refilling <= 1'b1;
+        delay <= DELAY_BITS'(MEM_LATENCY);
+        fill_line <= addr_i[DATA_WIDTH-1:OFFSET_BITS];
+        fill_way <= victim[set];
+        fill_word <= '0;
+    end
+end
+
+always_ff @(posedge clk) begin
+    if (fill_en)
+        lines[fill_way][fill_set][fill_word] <= mem_data_i;
+    if (fill_last)
+        tags[fill_way][fill_set] <= TAG_BITS'(fill_line >> INDEX_BITS);
+end
+
+endmodule
@@ -1,12 +1,13 @@
 module instrmem #(    
     parameter ADDR_WIDTH = 32,
-    parameter DATA_WIDTH = 8
+    parameter DATA_WIDTH = 8,
+    parameter MEM_ADDR_BITS = 12    //depth is 2^MEM_ADDR_BITS bytes from the reset vector
 ) (
     input logic  [ADDR_WIDTH-1:0] addr_i,
     output logic [ADDR_WIDTH-1:0] read_data_o
 );
 
-logic [DATA_WIDTH-1:0] rom_mem [32'hBFC00FFF : 32'hBFC00000];
+logic [DATA_WIDTH-1:0] rom_mem [32'hBFC00000 + 2**MEM_ADDR_BITS - 1 : 32'hBFC00000] /*verilator public*/;
 
 initial begin
     $readmemh("program.hex", rom_mem); // Load ROM contents from external file yet to be defined
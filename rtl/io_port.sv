@@ -0,0 +1,87 @@
+//memory-mapped i/o page at the top of the address space, so programs reach it with an offset from x0 (sw a0, -256(zero))
+//  0xFFFFFF00  OUT      store: push the word into the output fifo, load: number of words waiting in it
+//  0xFFFFFF04  TRIGGER  load: 1 if trigger has been high since the last load of TRIGGER, the load clears it
+//word accesses only, the data memory ignores stores into the page
+//the fifo drains through out_data_o/out_valid_o whenever out_ready_i is high, a store to a full fifo waits (stall_o)
+//until a word leaves it, so no word is lost while out_ready_i is low
+module io_port #(
+    parameter DATA_WIDTH = 32,
+    parameter FIFO_DEPTH = 16   //power of two
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+    input  logic [DATA_WIDTH-1:0]   addr_i,
+    input  logic [DATA_WIDTH-1:0]   write_data_i,
+    input  logic                    write_en_i,
+    input  logic                    read_en_i,
+    input  logic                    trigger_i,
+    input  logic                    out_ready_i,
+
+    output logic                    io_sel_o,       //addr_i is in the i/o page
+    output logic [DATA_WIDTH-1:0]   read_data_o,
+    output logic [DATA_WIDTH-1:0]   out_data_o,
+    output logic                    out_valid_o,
+    output logic                    stall_o         //a store to OUT waits for room in the fifo
+);
+
+localparam PTR_BITS = $clog2(FIFO_DEPTH);
+
+logic [DATA_WIDTH-1:0]  fifo [FIFO_DEPTH-1:0];
+logic [PTR_BITS-1:0]    head;
+logic [PTR_BITS-1:0]    tail;
+logic [PTR_BITS:0]      count;
+logic                   full;
+logic                   push;
+logic                   pop;
+logic                   out_sel;
+logic                   trigger_sel;
+logic                   pending;
+
+assign io_sel_o = (addr_i[DATA_WIDTH-1:8] == {(DATA_WIDTH-8){1'b1}});
+assign out_sel = io_sel_o && (addr_i[7:0] == 8'h00);
+assign trigger_sel = io_sel_o && (addr_i[7:0] == 8'h04);
+
+assign full = (count == (PTR_BITS+1)'(FIFO_DEPTH));
+assign pop = out_valid_o && out_ready_i;
+assign push = write_en_i && out_sel && (!full || pop);
+assign stall_o = write_en_i && out_sel && full && !pop;
+
+assign out_valid_o = (count != '0);
+assign out_data_o = fifo[head];
+
+always_comb begin
+    if (out_sel)
+        read_data_o = {{(DATA_WIDTH-PTR_BITS-1){1'b0}}, count};
+    else if (trigger_sel)
+        read_data_o = {{(DATA_WIDTH-1){1'b0}}, pending};
+    else
+        read_data_o = {DATA_WIDTH{1'b0}};
+end
+
+always_ff @(posedge clk) begin
+    if (push)
+        fifo[tail] <= write_data_i;
+end
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst) begin
+        head <= '0;
+        tail <= '0;
+        count <= '0;
+        pending <= 1'b0;
+    end
+    else begin
+        if (push)
+            tail <= tail + PTR_BITS'(1);
+        if (pop)
+            head <= head + PTR_BITS'(1);
+        if (push && !pop)
+            count <= count + (PTR_BITS+1)'(1);
+        else if (pop && !push)
+            count <= count - (PTR_BITS+1)'(1);
+        //a trigger that is still high when it's read stays pending
+        pending <= trigger_i || (pending && !(read_en_i && trigger_sel));
+    end
+end
+
+endmodule
@@ -1,36 +1,264 @@
 module memoryblock #(
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    parameter DMEM_ADDR_BITS = 17,
+    //data cache, none with DCACHE_BYTES 0 (see dcache.sv)
+    parameter DCACHE_BYTES = 0,
+    parameter DCACHE_LINE_BYTES = 16,
+    parameter DCACHE_WAYS = 2,
+    parameter DCACHE_VICTIM_ENTRIES = 0,
+    parameter DMEM_LATENCY = 4,
+    //loads that can miss without holding the core, blocking with 0
+    parameter DCACHE_MSHRS = 0,
+    //data prefetcher, none with PREFETCH_SCHEME 0 or without a data cache (see prefetcher.sv)
+    parameter PREFETCH_SCHEME = 0,
+    parameter STRIDE_ENTRIES = 16,
+    parameter PREFETCH_DISTANCE = 16,
+    //store buffer, none with STORE_BUFFER_ENTRIES 0 (see store_buffer.sv)
+    parameter STORE_BUFFER_ENTRIES = 0
 ) (
     input logic [DATA_WIDTH-1:0]    ALUResultM_i,
     input logic [DATA_WIDTH-1:0]    WriteDataM_i,
-    input logic [DATA_WIDTH-1:0]    PCPlus4M_i,
+    input logic [DATA_WIDTH-1:0]    PCM_i,          //trains the stride prefetcher
     input logic                     MemWrite_i,
+    input logic                     MemRead_i,
     input logic                     clk,
+    input logic                     rst,
     input logic [1:0]               MemType_i,
     input logic                     MemSign_i,
-    input logic [4:0]               RdE_i,
+    input logic                     trigger_i,
+    input logic                     out_ready_i,
+    input logic                     Drain_i,        //a fence or the halt loop, waits for the store buffer to empty
+                                                    //and the deferred loads to return
+    input logic [4:0]               RdM_i,          //the load's destination, kept if it is deferred
+    input logic                     CancelW_i,      //writeback writes RdW_i, a deferred load to it is dropped
+    input logic [4:0]               RdW_i,
+    input logic                     ReturnAck_i,    //the register file takes the returning load
 
-    output logic [DATA_WIDTH-1:0] ALUResultM_o,
     output logic [DATA_WIDTH-1:0] RD_o,
-    output logic [DATA_WIDTH-1:0] PCPlus4M_o,
-    output logic [4:0]            RdM_o
+    output logic [DATA_WIDTH-1:0] out_data_o,
+    output logic                  out_valid_o,
+    output logic                  Stall_o,      //a load/store waits on the store buffer, data cache or output fifo
+    output logic                  DAccess_o,    //a load/store completed in the data cache
+    output logic                  DMiss_o,      //a data cache miss was found
+    output logic                  DWriteback_o, //and it evicts a dirty line
+    output logic                  DVictimHit_o, //a miss in the sets hit the victim cache instead
+    output logic                  DPrefetch_o,  //a prefetch started
+    output logic                  DPrefetchHit_o, //a load/store hit a prefetched line for the first time
+    output logic                  SbForward_o,  //a load was answered from the store buffer
+    output logic                  SbStall_o,    //a load/store waits on the store buffer, low without one
+    output logic                  IoStall_o,    //a store waits for room in the output fifo
+    output logic                  Defer_o,      //a load missed and goes on without its data
+    output logic [31:0]           Pending_o,    //the registers deferred loads will write
+    output logic                  Return_o,     //a deferred load's data for the register file
+    output logic [4:0]            ReturnRd_o,
+    output logic [DATA_WIDTH-1:0] ReturnData_o
 );
 
-data_mem_top datamem(
-    .write_en_i(MemWrite_i),
+logic                  io_sel;
+logic [DATA_WIDTH-1:0] io_read_data;
+logic [DATA_WIDTH-1:0] mem_read_data;
+
+//the memory port, the data cache or data_mem_top, driven by the core's access or the store buffer
+logic                  port_read_en;
+logic                  port_write_en;
+logic [1:0]            port_type;
+logic                  port_sign;
+logic [DATA_WIDTH-1:0] port_addr;
+logic [DATA_WIDTH-1:0] port_write_data;
+logic [DATA_WIDTH-1:0] port_read_data;
+logic                  port_stall;
+logic                  access_stall;
+logic                  outstanding;    //a deferred load hasn't returned
+
+//the prefetcher's request to the data cache
+logic                  prefetch;
+logic [DATA_WIDTH-1:0] prefetch_addr;
+logic                  prefetch_ack;
+
+//data_mem_top's side, the core's access or the cache's word reads and writes
+logic                  dmem_read_en;
+logic                  dmem_write_en;
+logic [1:0]            dmem_type;
+logic                  dmem_sign;
+logic [DATA_WIDTH-1:0] dmem_write_data;
+logic [DATA_WIDTH-1:0] dmem_addr;
+logic [DATA_WIDTH-1:0] dmem_read_data;
+
+data_mem_top #(
+    .DMEM_ADDR_BITS(DMEM_ADDR_BITS)
+) datamem(
+    .read_en_i(dmem_read_en),
+    .write_en_i(dmem_write_en),
     .clk_i(clk),
-    .mem_type_i(MemType_i), //need to implement these control signals
-    .mem_sign_i(MemSign_i), //control signal?
-    .write_data_i(WriteDataM_i),
-    .addr_i(ALUResultM_i),
+    .mem_type_i(dmem_type), //need to implement these control signals
+    .mem_sign_i(dmem_sign), //control signal?
+    .write_data_i(dmem_write_data),
+    .addr_i(dmem_addr),
+
+    .read_data_o(dmem_read_data)
+
+);
+
+//stores to the i/o page don't reach the data memory, and i/o accesses bypass the store buffer and the cache
+generate
+    if (STORE_BUFFER_ENTRIES > 0) begin : buffer
+        store_buffer #(
+            .DATA_WIDTH(DATA_WIDTH),
+            .ENTRIES(STORE_BUFFER_ENTRIES)
+        ) store_buffer(
+            .clk(clk),
+            .rst(rst),
+            .read_en_i(MemRead_i && !io_sel),
+            .write_en_i(MemWrite_i && !io_sel),
+            .mem_type_i(MemType_i),
+            .mem_sign_i(MemSign_i),
+            .addr_i(ALUResultM_i),
+            .write_data_i(WriteDataM_i),
+            .drain_i(Drain_i),
+            .read_data_o(mem_read_data),
+            .stall_o(access_stall),
+            .buffer_stall_o(SbStall_o),
+            .forward_o(SbForward_o),
+            .mem_read_en_o(port_read_en),
+            .mem_write_en_o(port_write_en),
+            .mem_type_o(port_type),
+            .mem_sign_o(port_sign),
+            .mem_addr_o(port_addr),
+            .mem_write_data_o(port_write_data),
+            .mem_read_data_i(port_read_data),
+            .mem_stall_i(port_stall)
+        );
+    end
+    else begin : no_buffer
+        assign port_read_en = MemRead_i && !io_sel;
+        assign port_write_en = MemWrite_i && !io_sel;
+        assign port_type = MemType_i;
+        assign port_sign = MemSign_i;
+        assign port_addr = ALUResultM_i;
+        assign port_write_data = WriteDataM_i;
+        assign mem_read_data = port_read_data;
+        assign access_stall = port_stall;
+        assign SbStall_o = 1'b0;
+        assign SbForward_o = 1'b0;
+    end
+
+    if (DCACHE_BYTES > 0) begin : cache
+        dcache #(
+            .DATA_WIDTH(DATA_WIDTH),
+            .CACHE_BYTES(DCACHE_BYTES),
+            .LINE_BYTES(DCACHE_LINE_BYTES),
+            .WAYS(DCACHE_WAYS),
+            .MEM_LATENCY(DMEM_LATENCY),
+            .VICTIM_ENTRIES(DCACHE_VICTIM_ENTRIES),
+            .MSHRS(DCACHE_MSHRS)
+        ) dcache(
+            .clk(clk),
+            .rst(rst),
+            .read_en_i(port_read_en),
+            .write_en_i(port_write_en),
+            .mem_type_i(port_type),
+            .mem_sign_i(port_sign),
+            .addr_i(port_addr),
+            .write_data_i(port_write_data),
+            .read_data_o(port_read_data),
+            .stall_o(port_stall),
+            .miss_o(DMiss_o),
+            .writeback_o(DWriteback_o),
+            .victim_hit_o(DVictimHit_o),
+            .prefetch_i(prefetch),
+            .prefetch_addr_i(prefetch_addr),
+            .prefetch_ack_o(prefetch_ack),
+            .prefetch_o(DPrefetch_o),
+            .prefetch_hit_o(DPrefetchHit_o),
+            .dest_i(RdM_i),
+            .defer_o(Defer_o),
+            .pending_o(Pending_o),
+            .outstanding_o(outstanding),
+            .cancel_i(CancelW_i),
+            .cancel_dest_i(RdW_i),
+            .return_o(Return_o),
+            .return_dest_o(ReturnRd_o),
+            .return_data_o(ReturnData_o),
+            .return_ack_i(ReturnAck_i),
+            .mem_addr_o(dmem_addr),
+            .mem_read_o(dmem_read_en),
+            .mem_write_o(dmem_write_en),
+            .mem_write_data_o(dmem_write_data),
+            .mem_read_data_i(dmem_read_data)
+        );
+
+        assign dmem_type = 2'b00;
+        assign dmem_sign = 1'b0;
+        assign DAccess_o = (port_read_en || port_write_en) && !port_stall;
+
+        if (PREFETCH_SCHEME > 0) begin : data_prefetch
+            prefetcher #(
+                .DATA_WIDTH(DATA_WIDTH),
+                .SCHEME(PREFETCH_SCHEME),
+                .LINE_BYTES(DCACHE_LINE_BYTES),
+                .STRIDE_ENTRIES(STRIDE_ENTRIES),
+                .DISTANCE(PREFETCH_DISTANCE)
+            ) prefetcher(
+                .clk(clk),
+                .rst(rst),
+                .access_i(DAccess_o),
+                .load_i(port_read_en),
+                .pc_i(PCM_i),
+                .addr_i(port_addr),
+                .prefetch_o(prefetch),
+                .prefetch_addr_o(prefetch_addr),
+                .ack_i(prefetch_ack)
+            );
+        end
+        else begin : no_data_prefetch
+            assign prefetch = 1'b0;
+            assign prefetch_addr = '0;
+        end
+    end
+    else begin : no_cache
+        assign dmem_read_en = port_read_en;
+        assign dmem_write_en = port_write_en;
+        assign dmem_type = port_type;
+        assign dmem_sign = port_sign;
+        assign dmem_write_data = port_write_data;
+        assign dmem_addr = port_addr;
+        assign port_read_data = dmem_read_data;
+        assign port_stall = 1'b0;
+        assign DAccess_o = 1'b0;
+        assign DMiss_o = 1'b0;
+        assign DWriteback_o = 1'b0;
+        assign DVictimHit_o = 1'b0;
+        assign DPrefetch_o = 1'b0;
+        assign DPrefetchHit_o = 1'b0;
+        assign Defer_o = 1'b0;
+        assign Pending_o = '0;
+        assign outstanding = 1'b0;
+        assign Return_o = 1'b0;
+        assign ReturnRd_o = '0;
+        assign ReturnData_o = '0;
+    end
+endgenerate
 
-    .read_data_o(RD_o)
+assign Stall_o = access_stall || (Drain_i && outstanding) || IoStall_o;
+
+io_port io_port(
+    .clk(clk),
+    .rst(rst),
+    .addr_i(ALUResultM_i),
+    .write_data_i(WriteDataM_i),
+    .write_en_i(MemWrite_i),
+    .read_en_i(MemRead_i),
+    .trigger_i(trigger_i),
+    .out_ready_i(out_ready_i),
 
+    .io_sel_o(io_sel),
+    .read_data_o(io_read_data),
+    .out_data_o(out_data_o),
+    .out_valid_o(out_valid_o),
+    .stall_o(IoStall_o)
 );
 
-assign ALUResultM_o = ALUResultM_i; 
-assign PCPlus4M_o = PCPlus4M_i;
-assign RdM_o = RdE_i;
+assign RD_o = io_sel ? io_read_data : mem_read_data;
 
 
 endmodule
@@ -4,7 +4,10 @@ module pc_module #(
     input  logic clk,
     input  logic rst,
     input  logic PCsrc,
+    input  logic en_i,      //low holds the PC, the pipeline stalls fetch on a load-use hazard and an instruction cache miss does too
     input logic [DATA_WIDTH-1:0] PCTargetE_i, //this is the jump PC value coming after Execute
+    input  logic PredTaken_i,   //branch predictor, PCsrc (a redirect from execute) wins over it
+    input logic [DATA_WIDTH-1:0] PredTarget_i,
     //input  logic [DATA_WIDTH-1:0] ImmExt_i,
 
     output logic [DATA_WIDTH-1:0] PC,
@@ -15,6 +18,7 @@ module pc_module #(
     
     logic [DATA_WIDTH-1:0] next_PC;
     logic [DATA_WIDTH-1:0] inc_PC;
+    logic [DATA_WIDTH-1:0] predict_PC;
 
     assign inc_PC = PC + 32'd4;
     
@@ -23,8 +27,17 @@ module pc_module #(
 
     mux #(
         .DATA_WIDTH(DATA_WIDTH)
-    ) u_mux (
+    ) predict_mux (
         .in0(inc_PC),
+        .in1(PredTarget_i),
+        .sel(PredTaken_i),
+        .out(predict_PC)
+    );
+
+    mux #(
+        .DATA_WIDTH(DATA_WIDTH)
+    ) u_mux (
+        .in0(predict_PC),
         .in1(PCTargetE_i),
         .sel(PCsrc),
         .out(next_PC)
@@ -36,7 +49,7 @@ module pc_module #(
     always_ff @(posedge clk or posedge rst) begin
         if (rst)
             PC <= 32'hBFC00000; // reset address
-        else
+        else if (en_i)
             PC <= next_PC;
     end
     
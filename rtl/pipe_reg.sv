@@ -0,0 +1,34 @@
+//pipeline register between two stages of top, one per stage boundary with every signal that crosses it concatenated
+//en_i low holds the contents (stall), clear_i empties it at the next edge (flush), clear takes priority
+//a cleared register holds zeros, so valid, RegWrite, MemWrite... read as a bubble
+//with BYPASS set it is a wire and en_i/clear_i are ignored, which is how top builds the single cycle core
+module pipe_reg #(
+    parameter WIDTH = 32,
+    parameter BYPASS = 0
+) (
+    input  logic                clk,
+    input  logic                rst,
+    input  logic                en_i,
+    input  logic                clear_i,
+    input  logic [WIDTH-1:0]    d_i,
+
+    output logic [WIDTH-1:0]    q_o
+);
+
+generate
+    if (BYPASS) begin : bypass
+        assign q_o = d_i;
+    end
+    else begin : register
+        always_ff @(posedge clk or posedge rst) begin
+            if (rst)
+                q_o <= '0;
+            else if (clear_i)
+                q_o <= '0;
+            else if (en_i)
+                q_o <= d_i;
+        end
+    end
+endgenerate
+
+endmodule
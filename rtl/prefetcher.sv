@@ -0,0 +1,112 @@
+//data prefetcher for dcache.sv, only instantiated when top is built with a data cache and PREFETCH_SCHEME above 0
+//it trains on the loads and stores the cache completes and asks the cache for one line at a time, a newer request
+//replaces one the cache hasn't taken yet, the cache drops requests for lines it already has
+//  SCHEME 1  next line, every access asks for the line after its own
+//         2  stride, a table direct mapped on the load's PC and tagged with the rest of it holds the last address and
+//            stride of each load, a load asks for the line DISTANCE strides ahead once it moved by the same nonzero
+//            stride three times in a row (from its fourth access on: the first fills the entry, the second learns the
+//            stride, the third confirms it), loads without a steady stride (and stores) ask for nothing
+module prefetcher #(
+    parameter DATA_WIDTH = 32,
+    parameter SCHEME = 1,
+    parameter LINE_BYTES = 16,      //the data cache's
+    parameter STRIDE_ENTRIES = 16,  //power of two, at least 2
+    parameter DISTANCE = 16,        //strides ahead of the load a stride prefetch goes
+    localparam OFFSET_BITS = $clog2(LINE_BYTES),
+    localparam STRIDE_BITS = $clog2(STRIDE_ENTRIES),
+    localparam TAG_BITS = DATA_WIDTH - STRIDE_BITS - 2
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+
+    //training, a load or store the data cache completed
+    input  logic                    access_i,
+    input  logic                    load_i,         //it's the core's load, pc_i is its PC
+    input  logic [DATA_WIDTH-1:0]   pc_i,
+    input  logic [DATA_WIDTH-1:0]   addr_i,
+
+    //request to the data cache
+    output logic                    prefetch_o,
+    output logic [DATA_WIDTH-1:0]   prefetch_addr_o,
+    input  logic                    ack_i
+);
+
+logic                   trigger;
+logic [DATA_WIDTH-1:0]  target;
+
+generate
+    if (SCHEME == 2) begin : stride
+        logic                   valid [STRIDE_ENTRIES];
+        logic [TAG_BITS-1:0]    tags [STRIDE_ENTRIES];
+        logic [DATA_WIDTH-1:0]  last [STRIDE_ENTRIES];
+        logic [DATA_WIDTH-1:0]  strides [STRIDE_ENTRIES];
+        logic [1:0]             confidence [STRIDE_ENTRIES];   //strides repeated in a row, saturating
+
+        logic [STRIDE_BITS-1:0] index;
+        logic [TAG_BITS-1:0]    tag;
+        logic                   table_hit;
+        logic [DATA_WIDTH-1:0]  delta;
+        logic                   repeated;
+
+        assign index = pc_i[STRIDE_BITS+1:2];
+        assign tag = pc_i[DATA_WIDTH-1:STRIDE_BITS+2];
+        assign table_hit = valid[index] && (tags[index] == tag);
+        assign delta = addr_i - last[index];
+        assign repeated = table_hit && (delta == strides[index]);
+
+        //this access is the second repeat in a row, the stride was already confirmed once
+        assign trigger = access_i && load_i && repeated && (delta != '0) && (confidence[index] != 2'd0);
+        assign target = addr_i + delta * DATA_WIDTH'(DISTANCE);
+
+        always_ff @(posedge clk or posedge rst) begin
+            if (rst) begin
+                for (int i = 0; i < STRIDE_ENTRIES; i++) begin
+                    valid[i] <= 1'b0;
+                    confidence[i] <= 2'd0;
+                end
+            end
+            else if (access_i && load_i) begin
+                valid[index] <= 1'b1;
+                if (repeated)
+                    confidence[index] <= (confidence[index] == 2'd3) ? 2'd3 : confidence[index] + 2'd1;
+                else
+                    confidence[index] <= 2'd0;
+            end
+        end
+
+        //a load new to its entry starts with no stride, a changed stride is learned from the next access
+        always_ff @(posedge clk) begin
+            if (access_i && load_i) begin
+                tags[index] <= tag;
+                last[index] <= addr_i;
+                if (!table_hit)
+                    strides[index] <= '0;
+                else if (!repeated)
+                    strides[index] <= delta;
+            end
+        end
+    end
+    else if (SCHEME == 1) begin : next_line
+        assign trigger = access_i;
+        assign target = {addr_i[DATA_WIDTH-1:OFFSET_BITS], OFFSET_BITS'(0)} + DATA_WIDTH'(LINE_BYTES);
+    end
+    else begin : none
+        assign trigger = 1'b0;
+        assign target = '0;
+    end
+endgenerate
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst) begin
+        prefetch_o <= 1'b0;
+        prefetch_addr_o <= '0;
+    end
+    else if (trigger) begin
+        prefetch_o <= 1'b1;
+        prefetch_addr_o <= target;
+    end
+    else if (ack_i)
+        prefetch_o <= 1'b0;
+end
+
+endmodule
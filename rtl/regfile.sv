@@ -19,7 +19,7 @@ module regfile #(
 
 
     // register file: 32 entries of DATA_WIDTH bits
-    logic [DATA_WIDTH-1:0] regs [2**ADDRESS_WIDTH-1:0];
+    logic [DATA_WIDTH-1:0] regs [2**ADDRESS_WIDTH-1:0] /*verilator public*/;
 
 
     //write logic with x0 protection 
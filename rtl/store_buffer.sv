@@ -0,0 +1,161 @@
+//store buffer between memoryblock and its memory port (dcache.sv, or data_mem_top without one), only instantiated when
+//top is built with STORE_BUFFER_ENTRIES above 0, stores retire into it and drain to memory in order whenever the
+//core's access isn't a load that needs the port, so a store never waits on the memory side unless the buffer is full
+//a load whose bytes are all in buffered stores is answered from them, the youngest store of each byte winning, a load
+//that only partly overlaps them stalls until they drained, and one that doesn't overlap goes to memory past them
+//drain_i (a fence, or the halt loop so memory is up to date when the core halts) stalls until the buffer is empty
+module store_buffer #(
+    parameter DATA_WIDTH = 32,
+    parameter ENTRIES = 4,
+    localparam SLOT_BITS = (ENTRIES > 1) ? $clog2(ENTRIES) : 1,
+    localparam COUNT_BITS = $clog2(ENTRIES + 1)
+) (
+    input  logic                    clk,
+    input  logic                    rst,
+
+    //core side, data_mem_top's
+    input  logic                    read_en_i,
+    input  logic                    write_en_i,
+    input  logic [1:0]              mem_type_i,
+    input  logic                    mem_sign_i,
+    input  logic [DATA_WIDTH-1:0]   addr_i,
+    input  logic [DATA_WIDTH-1:0]   write_data_i,
+    input  logic                    drain_i,
+    output logic [DATA_WIDTH-1:0]   read_data_o,
+    output logic                    stall_o,
+    output logic                    buffer_stall_o, //stall_o for the buffer itself rather than the memory side
+    output logic                    forward_o,      //a load was answered from the buffer
+
+    //memory side, the same interface and a stall from it, low for data_mem_top
+    output logic                    mem_read_en_o,
+    output logic                    mem_write_en_o,
+    output logic [1:0]              mem_type_o,
+    output logic                    mem_sign_o,
+    output logic [DATA_WIDTH-1:0]   mem_addr_o,
+    output logic [DATA_WIDTH-1:0]   mem_write_data_o,
+    input  logic [DATA_WIDTH-1:0]   mem_read_data_i,
+    input  logic                    mem_stall_i
+);
+
+//the stores oldest first, entry 0 is the next to drain
+logic [DATA_WIDTH-1:0]  addrs [ENTRIES];
+logic [1:0]             types [ENTRIES];
+logic [DATA_WIDTH-1:0]  datas [ENTRIES];
+logic [COUNT_BITS-1:0]  count;
+
+//the bytes of its word an access touches and a store's data moved onto them, like data_mem_i places it
+function automatic logic [3:0] lanes(input logic [1:0] mem_type, input logic [1:0] offset);
+    case (mem_type)
+        2'b01: lanes = 4'b0001 << offset;
+        2'b10: lanes = offset[1] ? 4'b1100 : 4'b0011;
+        default: lanes = 4'b1111;
+    endcase
+endfunction
+
+function automatic logic [DATA_WIDTH-1:0] lane_data(input logic [1:0] mem_type, input logic [DATA_WIDTH-1:0] data);
+    case (mem_type)
+        2'b01: lane_data = {4{data[7:0]}};
+        2'b10: lane_data = {2{data[15:0]}};
+        default: lane_data = data;
+    endcase
+endfunction
+
+logic [3:0]             store_lanes [ENTRIES];
+logic [DATA_WIDTH-1:0]  store_words [ENTRIES];
+logic [3:0]             load_lanes;
+logic [3:0]             covered;
+logic [DATA_WIDTH-1:0]  forward_word;
+logic [DATA_WIDTH-1:0]  forward_data;
+logic                   full_forward;
+logic                   partial;
+logic                   port_load;      //the core's load goes to memory this cycle
+logic                   draining;       //the oldest store is in memory and waits on it
+logic                   issue;
+logic                   retire;
+logic                   full;
+logic                   store_stall;
+logic [SLOT_BITS-1:0]   slot;           //where a new store goes
+
+always_comb begin
+    for (int i = 0; i < ENTRIES; i++) begin
+        store_lanes[i] = lanes(types[i], addrs[i][1:0]);
+        store_words[i] = lane_data(types[i], datas[i]);
+    end
+end
+
+assign load_lanes = lanes(mem_type_i, addr_i[1:0]);
+
+always_comb begin
+    covered = 4'b0;
+    forward_word = '0;
+    for (int i = 0; i < ENTRIES; i++) begin
+        if ((COUNT_BITS'(i) < count) && (addrs[i][DATA_WIDTH-1:2] == addr_i[DATA_WIDTH-1:2])) begin
+            covered = covered | (store_lanes[i] & load_lanes);
+            for (int b = 0; b < 4; b++)
+                if (store_lanes[i][b])
+                    forward_word[8*b +: 8] = store_words[i][8*b +: 8];
+        end
+    end
+end
+
+assign full_forward = read_en_i && (covered == load_lanes);
+assign partial = read_en_i && (covered != 4'b0) && (covered != load_lanes);
+
+//the load's bytes out of the merged word, like data_mem_top extends them
+data_mem_o data_mem_o(
+    .mem_type_i(mem_type_i),
+    .mem_sign_i(mem_sign_i),
+    .addr_i(addr_i),
+    .read_data_i(forward_word),
+    .read_data_o(forward_data)
+);
+
+//a load has the port unless a store already waits on memory, the oldest store gets it otherwise
+assign port_load = read_en_i && (covered == 4'b0) && !draining;
+assign issue = (count != '0) && !port_load;
+assign retire = issue && !mem_stall_i;
+assign full = (count == COUNT_BITS'(ENTRIES));
+assign store_stall = write_en_i && full && !retire;
+assign slot = SLOT_BITS'(retire ? count - COUNT_BITS'(1) : count);
+
+assign mem_read_en_o = port_load;
+assign mem_write_en_o = issue;
+assign mem_type_o = issue ? types[0] : mem_type_i;
+assign mem_sign_o = mem_sign_i;
+assign mem_addr_o = issue ? addrs[0] : addr_i;
+assign mem_write_data_o = datas[0];
+
+assign read_data_o = full_forward ? forward_data : mem_read_data_i;
+assign forward_o = full_forward;
+assign buffer_stall_o = partial || store_stall || (read_en_i && (covered == 4'b0) && draining)
+                     || (drain_i && (count != '0));
+assign stall_o = buffer_stall_o || (port_load && mem_stall_i);
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst) begin
+        count <= '0;
+        draining <= 1'b0;
+    end
+    else begin
+        count <= count - COUNT_BITS'(retire) + COUNT_BITS'(write_en_i && !store_stall);
+        draining <= issue && mem_stall_i;
+    end
+end
+
+//retiring shifts the stores down, a new one goes in behind the last
+always_ff @(posedge clk) begin
+    if (retire) begin
+        for (int i = 0; i < ENTRIES - 1; i++) begin
+            addrs[i] <= addrs[i+1];
+            types[i] <= types[i+1];
+            datas[i] <= datas[i+1];
+        end
+    end
+    if (write_en_i && !store_stall) begin
+        addrs[slot] <= addr_i;
+        types[slot] <= mem_type_i;
+        datas[slot] <= write_data_i;
+    end
+end
+
+endmodule
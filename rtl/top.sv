@@ -1,156 +1,751 @@
 module top #(
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    //memory depths in address bits, overridable with verilator -G (see tb/sweep.sh)
+    parameter IMEM_ADDR_BITS = 12,
+    parameter DMEM_ADDR_BITS = 17,
+    //0: single cycle, 1: five stage pipeline with forwarding, load-use stalls and flushes on mispredicted branches/jumps
+    parameter PIPELINED = 0,
+    //branch predictor of the pipelined core, 0 none, 1 static BTFN, 2 bimodal, 3 gshare (see branch_predictor.sv)
+    parameter BP_SCHEME = 2,
+    parameter BTB_ENTRIES = 16,
+    parameter BHT_ENTRIES = 64,
+    parameter GHR_BITS = 6,
+    //return address stack and indirect target cache, the jalr predictors
+    parameter RAS_ENTRIES = 8,
+    parameter ITC_ENTRIES = 4,
+    //instruction cache in front of instrmem, none with ICACHE_BYTES 0, and the latency of instrmem behind it (see icache.sv)
+    parameter ICACHE_BYTES = 0,
+    parameter ICACHE_LINE_BYTES = 16,
+    parameter ICACHE_WAYS = 1,
+    parameter IMEM_LATENCY = 4,
+    //data cache in front of data_mem, none with DCACHE_BYTES 0, its victim cache, none with DCACHE_VICTIM_ENTRIES 0,
+    //and the latency of data_mem behind it (see dcache.sv)
+    parameter DCACHE_BYTES = 0,
+    parameter DCACHE_LINE_BYTES = 16,
+    parameter DCACHE_WAYS = 2,
+    parameter DCACHE_VICTIM_ENTRIES = 0,
+    parameter DMEM_LATENCY = 4,
+    //loads that can miss in the data cache without holding the pipelined core, blocking with 0 and on the single cycle core
+    parameter DCACHE_MSHRS = 0,
+    //data prefetcher into the data cache, 0 none, 1 next line, 2 stride (see prefetcher.sv)
+    parameter PREFETCH_SCHEME = 0,
+    parameter STRIDE_ENTRIES = 16,
+    parameter PREFETCH_DISTANCE = 16,
+    //store buffer between the memory stage and the data cache or data_mem, none with 0 (see store_buffer.sv)
+    parameter STORE_BUFFER_ENTRIES = 0
 ) (
     input  logic                    clk,
     input  logic                    rst,
-    input  logic                    trigger,
-    output logic [DATA_WIDTH-1:0]   a0
+    input  logic                    trigger,    //latched, programs read it at 0xFFFFFF04 (see io_port.sv)
+    input  logic                    out_ready,
+    output logic [DATA_WIDTH-1:0]   a0,
+    //output fifo, one word per store to 0xFFFFFF00, popped on every cycle with out_valid and out_ready high,
+    //a store to a full one holds the core until a word is popped
+    output logic [DATA_WIDTH-1:0]   out_data,
+    output logic                    out_valid
 );
 
-//wires for outputs are declared before each module
-logic           RegWrite;
-logic [3:0]     ALUCtrl;
-logic           ALUSrcB;
-logic           ALUSrcA;
-logic [2:0]     ImmSrc;
-logic           PCSrc;
-logic           MemWrite;
-logic [1:0]     ResultSrc;
-logic [1:0]     MemType;
-logic           MemSign;
-logic           JumpSrc;
-logic [2:0]     Branch;
+localparam BHT_BITS = $clog2(BHT_ENTRIES);
+localparam RAS_BITS = $clog2(RAS_ENTRIES);
 
-controlunit controlunit (
-    .Instr_i(Instr),
-    .branchTaken_i(branchTaken),         
-
-    .RegWrite_o(RegWrite),
-    .ALUCtrl_o(ALUCtrl),     
-    .ALUSrcB_o(ALUSrcB),
-    .ALUSrcA_o(ALUSrcA),
-    .ImmSrc_o(ImmSrc),       
-    .PCSrc_o(PCSrc),
-    .MemWrite_o(MemWrite),    
-    .ResultSrc_o(ResultSrc),
-    .MemSign_o(MemSign),
-    .MemType_o(MemType),
-    .JumpSrc_o(JumpSrc),
-    .Branch_o(Branch)
-);
+//signals carry the suffix of the stage they belong to, F/D/E/M/W
+//the pipe_reg between two stages is a wire in the single cycle core, so every stage sees the same instruction
+//valid is low for a bubble, flushed registers clear it along with RegWrite, MemWrite...
 
-logic [4:0] A1;
-logic [4:0] A2;
-logic [4:0] A3;
-logic [DATA_WIDTH-1:0] PCPlus4F;
+//hazard unit outputs, stalls and flushes are low in the single cycle core
+logic           StallF;
+logic           StallD;
+logic           FlushD;
+logic           FlushE;
+//a load/store in memory waiting on the data cache holds the whole core, decode to writeback keep their instructions
+//and writeback only writes the register file once it is through
+logic           MemStallM;
+//a load miss the data cache deferred leaves memory without its data, which comes back later through the register
+//file's write port in a cycle writeback doesn't use, decode waits for the registers still pending
+logic           DDeferM;
+logic [31:0]    DPendingM;
+logic           WritebackW;     //writeback writes a register
+logic           ReturnW;        //a deferred load's data for the register file
+logic [4:0]     ReturnRdW;
+logic [DATA_WIDTH-1:0] ReturnDataW;
+
+//------------------------------------------------------------ fetch
 logic [DATA_WIDTH-1:0] PCF;
-logic [DATA_WIDTH-1:0] Instr;
+logic [DATA_WIDTH-1:0] PCPlus4F;
+logic [DATA_WIDTH-1:0] InstrF;
+logic                  validF;     //low while the instruction cache refills, decode gets a bubble
+logic                  IMissF;
+logic [4:0]            Rs1F;
+logic [4:0]            Rs2F;
+logic [4:0]            RdF;
+logic                  RedirectE;
+logic [DATA_WIDTH-1:0] RedirectPCE;
+//branch predictor outputs for the instruction being fetched, all low in the single cycle core
+logic                  PredTakenF;
+logic [DATA_WIDTH-1:0] PredTargetF;
+logic                  PredHitF;
+logic [BHT_BITS-1:0]   BHTIndexF;
+logic [RAS_BITS-1:0]   RasPtrF;
 
-fetch fetch(
-    .PCSrc_i(PCSrc),
+fetch #(
+    .IMEM_ADDR_BITS(IMEM_ADDR_BITS),
+    .ICACHE_BYTES(ICACHE_BYTES),
+    .ICACHE_LINE_BYTES(ICACHE_LINE_BYTES),
+    .ICACHE_WAYS(ICACHE_WAYS),
+    .IMEM_LATENCY(IMEM_LATENCY)
+) fetch(
+    .PCSrc_i(RedirectE),
+    .StallF_i(StallF),
     .clk(clk),
     .rst(rst),
-    .PCTargetE_i(PCTargetE),
+    .PCTargetE_i(RedirectPCE),
+    .PredTaken_i(PredTakenF),
+    .PredTarget_i(PredTargetF),
 
     .PC_Plus4_F(PCPlus4F),
     .PC_F(PCF),
-    .Instr_o(Instr),
-    .A1_o(A1),
-    .A2_o(A2),
-    .A3_o(A3)
+    .Instr_o(InstrF),
+    .Ready_o(validF),
+    .IMiss_o(IMissF),
+    .A1_o(Rs1F),
+    .A2_o(Rs2F),
+    .A3_o(RdF)
 );
 
-logic [DATA_WIDTH-1:0] PCPlus4D;
+//------------------------------------------------------------ decode
+logic [DATA_WIDTH-1:0] InstrD;
 logic [DATA_WIDTH-1:0] PCD;
-logic [DATA_WIDTH-1:0] RD1;
-logic [DATA_WIDTH-1:0] RD2;
-logic [DATA_WIDTH-1:0] ImmExt;
-logic [4:0]           RdD;
+logic [DATA_WIDTH-1:0] PCPlus4D;
+logic [4:0]            Rs1D;
+logic [4:0]            Rs2D;
+logic [4:0]            RdD;
+logic                  validD;
+logic                  PredTakenD;
+logic [DATA_WIDTH-1:0] PredTargetD;
+logic                  PredHitD;
+logic [BHT_BITS-1:0]   BHTIndexD;
+logic [RAS_BITS-1:0]   RasPtrD;
+
+pipe_reg #(
+    .WIDTH(4*DATA_WIDTH + 18 + BHT_BITS + RAS_BITS),
+    .BYPASS(!PIPELINED)
+) fd_reg(
+    .clk(clk),
+    .rst(rst),
+    .en_i(!StallD),
+    .clear_i(FlushD),
+    .d_i({InstrF, PCF, PCPlus4F, Rs1F, Rs2F, RdF, validF, PredTakenF, PredTargetF, PredHitF, BHTIndexF, RasPtrF}),
+    .q_o({InstrD, PCD, PCPlus4D, Rs1D, Rs2D, RdD, validD, PredTakenD, PredTargetD, PredHitD, BHTIndexD, RasPtrD})
+);
+
+logic           RegWriteD;
+logic [3:0]     ALUCtrlD;
+logic           ALUSrcBD;
+logic           ALUSrcAD;
+logic [2:0]     ImmSrcD;
+logic           JumpD;
+logic           MemWriteD;
+logic [1:0]     ResultSrcD;
+logic [1:0]     MemTypeD;
+logic           MemSignD;
+logic           JumpSrcD;
+logic [2:0]     BranchD;
+logic           BranchOpD;
+logic           CallD;
+logic           RetD;
+logic           FenceD;
+
+//branches are resolved in execute, so with branchTaken_i low PCSrc_o flags the jumps
+controlunit controlunit (
+    .Instr_i(InstrD),
+    .branchTaken_i(1'b0),
+
+    .RegWrite_o(RegWriteD),
+    .ALUCtrl_o(ALUCtrlD),
+    .ALUSrcB_o(ALUSrcBD),
+    .ALUSrcA_o(ALUSrcAD),
+    .ImmSrc_o(ImmSrcD),
+    .PCSrc_o(JumpD),
+    .MemWrite_o(MemWriteD),
+    .ResultSrc_o(ResultSrcD),
+    .MemSign_o(MemSignD),
+    .MemType_o(MemTypeD),
+    .JumpSrc_o(JumpSrcD),
+    .Branch_o(BranchD)
+);
+
+//conditional branches, which train the direction predictor
+assign BranchOpD = (InstrD[6:0] == 7'd99);
+//calls link to ra, returns are jalr x0, 0(ra), for the return address stack
+assign CallD = JumpD && (RdD == 5'd1);
+assign RetD = JumpD && JumpSrcD && (RdD == 5'd0) && (Rs1D == 5'd1);
+//fence decodes as a nop otherwise, it drains the store buffer in memory
+assign FenceD = (InstrD[6:0] == 7'd15);
+
+logic [DATA_WIDTH-1:0] RFData1D;
+logic [DATA_WIDTH-1:0] RFData2D;
+logic [DATA_WIDTH-1:0] RD1D;
+logic [DATA_WIDTH-1:0] RD2D;
+logic [DATA_WIDTH-1:0] ImmExtD;
+logic [DATA_WIDTH-1:0] ResultW;
+logic [4:0]            RdW;
+logic                  RegWriteW;
 
 decode decode(
-    .ImmSrc_i(ImmSrc),
-    .PC_Plus4_F_i(PCPlus4F),
-    .PC_F_i(PCF),
+    .ImmSrc_i(ImmSrcD),
     .clk(clk),
-    .A1_i(A1),
-    .A2_i(A2),
-    .RdF_i(A3),
-    .instr_i(Instr),
-    .WD3_i(ResultW),
-    .WE3_i(RegWrite),
-    .RdW_i(RdW),
+    .A1_i(Rs1D),
+    .A2_i(Rs2D),
+    .instr_i(InstrD),
+    .WD3_i(WritebackW ? ResultW : ReturnDataW),
+    .WE3_i(WritebackW || ReturnW),
+    .RdW_i(WritebackW ? RdW : ReturnRdW),
 
-    .RD1_o(RD1),
-    .RD2_o(RD2),
-    .ImmExtD_o(ImmExt),
-    .PC_Plus4D_o(PCPlus4D),
-    .PCD_o(PCD), 
-    .a0_o(a0),
-    .RdD_o(RdD)
+    .RD1_o(RFData1D),
+    .RD2_o(RFData2D),
+    .ImmExtD_o(ImmExtD),
+    .a0_o(a0)
 );
 
+//------------------------------------------------------------ execute
+logic           RegWriteE;
+logic [1:0]     ResultSrcE;
+logic           MemWriteE;
+logic [1:0]     MemTypeE;
+logic           MemSignE;
+logic           JumpE;
+logic           JumpSrcE;
+logic [2:0]     BranchE;
+logic [3:0]     ALUCtrlE;
+logic           ALUSrcAE;
+logic           ALUSrcBE;
+logic [DATA_WIDTH-1:0] RD1E;
+logic [DATA_WIDTH-1:0] RD2E;
+logic [DATA_WIDTH-1:0] PCE;
+logic [DATA_WIDTH-1:0] ImmExtE;
 logic [DATA_WIDTH-1:0] PCPlus4E;
-logic [DATA_WIDTH-1:0] ALUResult;
-logic [DATA_WIDTH-1:0] WriteData;
+logic [4:0]            Rs1E;
+logic [4:0]            Rs2E;
+logic [4:0]            RdE;
+logic                  validE;
+logic                  BranchOpE;
+logic                  PredTakenE;
+logic [DATA_WIDTH-1:0] PredTargetE;
+logic                  PredHitE;
+logic [BHT_BITS-1:0]   BHTIndexE;
+logic                  CallE;
+logic                  RetE;
+logic [RAS_BITS-1:0]   RasPtrE;
+logic                  FenceE;
+
+pipe_reg #(
+    .WIDTH(6*DATA_WIDTH + 40 + BHT_BITS + RAS_BITS),
+    .BYPASS(!PIPELINED)
+) de_reg(
+    .clk(clk),
+    .rst(rst),
+    .en_i(!MemStallM),
+    .clear_i(FlushE),
+    .d_i({RegWriteD, ResultSrcD, MemWriteD, MemTypeD, MemSignD, JumpD, JumpSrcD, BranchD, ALUCtrlD, ALUSrcAD, ALUSrcBD,
+          RD1D, RD2D, PCD, ImmExtD, PCPlus4D, Rs1D, Rs2D, RdD, validD,
+          BranchOpD, PredTakenD, PredTargetD, PredHitD, BHTIndexD, CallD, RetD, RasPtrD, FenceD}),
+    .q_o({RegWriteE, ResultSrcE, MemWriteE, MemTypeE, MemSignE, JumpE, JumpSrcE, BranchE, ALUCtrlE, ALUSrcAE, ALUSrcBE,
+          RD1E, RD2E, PCE, ImmExtE, PCPlus4E, Rs1E, Rs2E, RdE, validE,
+          BranchOpE, PredTakenE, PredTargetE, PredHitE, BHTIndexE, CallE, RetE, RasPtrE, FenceE})
+);
+
+//operands forwarded from the instructions ahead in memory and writeback, muxed with the hazards below
+logic [DATA_WIDTH-1:0] ResultM;
+logic [DATA_WIDTH-1:0] FwdRD1E;
+logic [DATA_WIDTH-1:0] FwdRD2E;
+
+logic [DATA_WIDTH-1:0] ALUResultE;
+logic [DATA_WIDTH-1:0] WriteDataE;
 logic [DATA_WIDTH-1:0] PCTargetE;
-logic [4:0]           RdE;
-logic                 branchTaken;
+logic                  branchTakenE;
 
 execute execute(
-    .RD1E_i(RD1),
-    .RD2E_i(RD2),
-    .PCE_i(PCD),
-    .ImmExtE_i(ImmExt),
-    .PCPlus4E_i(PCPlus4D),
-    .ALUCtrl_i(ALUCtrl),
-    .ALUSrcB_i(ALUSrcB),
-    .ALUSrcA_i(ALUSrcA),
-    .JumpCtrl_i(JumpSrc),
-    .BranchSrc_i(Branch),
-    .RdD_i(RdD),
-
-    .ALUResultE_o(ALUResult),
-    .WriteDataE_o(WriteData),
-    .PCPlus4E_o(PCPlus4E),
+    .RD1E_i(FwdRD1E),
+    .RD2E_i(FwdRD2E),
+    .PCE_i(PCE),
+    .ImmExtE_i(ImmExtE),
+    .ALUCtrl_i(ALUCtrlE),
+    .ALUSrcB_i(ALUSrcBE),
+    .ALUSrcA_i(ALUSrcAE),
+    .JumpCtrl_i(JumpSrcE),
+    .BranchSrc_i(BranchE),
+
+    .ALUResultE_o(ALUResultE),
+    .WriteDataE_o(WriteDataE),
     .PCTargetE_o(PCTargetE),
-    .RdE_o(RdE),
-    .branchTaken_o(branchTaken)
+    .branchTaken_o(branchTakenE)
 );
 
-logic [DATA_WIDTH-1:0] PCPlus4M;
-logic [DATA_WIDTH-1:0] ALUResultM;
-logic [DATA_WIDTH-1:0] RDM;
-logic [4:0]           RdM;
+//a bubble holds zeros, which the ALU reads as a BEQ
+logic TakenE;
+assign TakenE = validE && (JumpE || branchTakenE);
+
+//fetch went on to the predicted target or PC+4, redirect it when that was wrong
+//in the single cycle core nothing is predicted, so every taken branch/jump redirects
+assign RedirectE = validE && (PredTakenE ? (!TakenE || (PredTargetE != PCTargetE)) : TakenE);
+assign RedirectPCE = TakenE ? PCTargetE : PCPlus4E;
 
+//the halt loop every test program ends in is a taken branch/jump to its own PC
+logic haltE;
+assign haltE = TakenE && (PCTargetE == PCE);
 
-memoryblock memory(
-    .ALUResultM_i(ALUResult),
-    .WriteDataM_i(WriteData),
-    .PCPlus4M_i(PCPlus4E),
-    .MemWrite_i(MemWrite),
+//------------------------------------------------------------ branch prediction
+//looks up the fetch PC and instruction and learns from the branches and jumps resolving in execute
+logic UpdateE;
+assign UpdateE = validE && !MemStallM && (BranchOpE || JumpE);
+
+generate
+    if (PIPELINED) begin : prediction
+        branch_predictor #(
+            .SCHEME(BP_SCHEME),
+            .BTB_ENTRIES(BTB_ENTRIES),
+            .BHT_ENTRIES(BHT_ENTRIES),
+            .GHR_BITS(GHR_BITS),
+            .RAS_ENTRIES(RAS_ENTRIES),
+            .ITC_ENTRIES(ITC_ENTRIES)
+        ) branch_predictor(
+            .clk(clk),
+            .rst(rst),
+            .PCF_i(PCF),
+            .InstrF_i(InstrF),
+            .StallF_i(StallF),
+            .PredTakenF_o(PredTakenF),
+            .PredTargetF_o(PredTargetF),
+            .PredHitF_o(PredHitF),
+            .BHTIndexF_o(BHTIndexF),
+            .RasPtrF_o(RasPtrF),
+            .UpdateE_i(UpdateE),
+            .BranchE_i(BranchOpE),
+            .JalrE_i(JumpSrcE),
+            .TakenE_i(TakenE),
+            .PCE_i(PCE),
+            .TargetE_i(PCTargetE),
+            .BHTIndexE_i(BHTIndexE),
+            .RedirectE_i(RedirectE),
+            .CallE_i(CallE),
+            .RetE_i(RetE),
+            .RasPtrE_i(RasPtrE),
+            .PCPlus4E_i(PCPlus4E)
+        );
+    end
+    else begin : no_prediction
+        assign PredTakenF = 1'b0;
+        assign PredTargetF = '0;
+        assign PredHitF = 1'b0;
+        assign BHTIndexF = '0;
+        assign RasPtrF = '0;
+    end
+endgenerate
+
+//------------------------------------------------------------ memory
+logic           RegWriteM;
+logic [1:0]     ResultSrcM;
+logic           MemWriteM;
+logic [1:0]     MemTypeM;
+logic           MemSignM;
+logic [DATA_WIDTH-1:0] ALUResultM;
+logic [DATA_WIDTH-1:0] WriteDataM;
+logic [DATA_WIDTH-1:0] PCPlus4M;
+logic [4:0]            RdM;
+logic                  validM;
+logic                  haltM;
+logic                  FenceM;
+
+pipe_reg #(
+    .WIDTH(3*DATA_WIDTH + 15),
+    .BYPASS(!PIPELINED)
+) em_reg(
     .clk(clk),
-    .MemSign_i(MemSign),
-    .MemType_i(MemType),
-    .RdE_i(RdE),
-
-    .ALUResultM_o(ALUResultM),
-    .RD_o(RDM),
-    .PCPlus4M_o(PCPlus4M),
-    .RdM_o(RdM)
+    .rst(rst),
+    .en_i(!MemStallM),
+    .clear_i(1'b0),
+    .d_i({RegWriteE, ResultSrcE, MemWriteE, MemTypeE, MemSignE, ALUResultE, WriteDataE, PCPlus4E, RdE, validE, haltE, FenceE}),
+    .q_o({RegWriteM, ResultSrcM, MemWriteM, MemTypeM, MemSignM, ALUResultM, WriteDataM, PCPlus4M, RdM, validM, haltM, FenceM})
 );
 
-logic [DATA_WIDTH-1:0] ResultW;
-logic [4:0]           RdW;
+logic [DATA_WIDTH-1:0] ReadDataM;
 
-writeback writeback(
+logic                  DAccessM;
+logic                  DMissM;
+logic                  DWritebackM;
+logic                  DVictimHitM;
+logic                  DPrefetchM;
+logic                  DPrefetchHitM;
+logic                  SbForwardM;
+logic                  SbStallM;
+logic                  IoStallM;
+
+memoryblock #(
+    .DMEM_ADDR_BITS(DMEM_ADDR_BITS),
+    .DCACHE_BYTES(DCACHE_BYTES),
+    .DCACHE_LINE_BYTES(DCACHE_LINE_BYTES),
+    .DCACHE_WAYS(DCACHE_WAYS),
+    .DCACHE_VICTIM_ENTRIES(DCACHE_VICTIM_ENTRIES),
+    .DMEM_LATENCY(DMEM_LATENCY),
+    .DCACHE_MSHRS(PIPELINED ? DCACHE_MSHRS : 0),
+    .PREFETCH_SCHEME(PREFETCH_SCHEME),
+    .STRIDE_ENTRIES(STRIDE_ENTRIES),
+    .PREFETCH_DISTANCE(PREFETCH_DISTANCE),
+    .STORE_BUFFER_ENTRIES(STORE_BUFFER_ENTRIES)
+) memory(
     .ALUResultM_i(ALUResultM),
-    .ReadDataW_i(RDM),
-    .PCPlus4W_i(PCPlus4M),
-    .ResultSrc_i(ResultSrc),
+    .WriteDataM_i(WriteDataM),
+    .PCM_i(PCPlus4M - 32'd4),
+    .MemWrite_i(MemWriteM),
+    .MemRead_i(ResultSrcM == 2'b01),
+    .clk(clk),
+    .rst(rst),
+    .MemSign_i(MemSignM),
+    .MemType_i(MemTypeM),
+    .trigger_i(trigger),
+    .out_ready_i(out_ready),
+    .Drain_i(FenceM || haltM),
     .RdM_i(RdM),
+    .CancelW_i(WritebackW),
+    .RdW_i(RdW),
+    .ReturnAck_i(!WritebackW),
+
+    .RD_o(ReadDataM),
+    .out_data_o(out_data),
+    .out_valid_o(out_valid),
+    .Stall_o(MemStallM),
+    .DAccess_o(DAccessM),
+    .DMiss_o(DMissM),
+    .DWriteback_o(DWritebackM),
+    .DVictimHit_o(DVictimHitM),
+    .DPrefetch_o(DPrefetchM),
+    .DPrefetchHit_o(DPrefetchHitM),
+    .SbForward_o(SbForwardM),
+    .SbStall_o(SbStallM),
+    .IoStall_o(IoStallM),
+    .Defer_o(DDeferM),
+    .Pending_o(DPendingM),
+    .Return_o(ReturnW),
+    .ReturnRd_o(ReturnRdW),
+    .ReturnData_o(ReturnDataW)
+);
+
+//what execute forwards from memory, a load never needs to (load-use stall)
+assign ResultM = (ResultSrcM == 2'b10) ? PCPlus4M : ALUResultM;
+
+//------------------------------------------------------------ writeback
+logic [1:0]            ResultSrcW;
+logic [DATA_WIDTH-1:0] ALUResultW;
+logic [DATA_WIDTH-1:0] ReadDataW;
+logic [DATA_WIDTH-1:0] PCPlus4W;
+logic                  validW;
+logic                  haltW;
+
+pipe_reg #(
+    .WIDTH(3*DATA_WIDTH + 10),
+    .BYPASS(!PIPELINED)
+) mw_reg(
+    .clk(clk),
+    .rst(rst),
+    .en_i(!MemStallM),
+    .clear_i(1'b0),
+    .d_i({RegWriteM && !DDeferM, ResultSrcM, ALUResultM, ReadDataM, PCPlus4M, RdM, validM, haltM}),
+    .q_o({RegWriteW, ResultSrcW, ALUResultW, ReadDataW, PCPlus4W, RdW, validW, haltW})
+);
+
+assign WritebackW = RegWriteW && (RdW != 5'b0) && !MemStallM;
+
+writeback writeback(
+    .ALUResultM_i(ALUResultW),
+    .ReadDataW_i(ReadDataW),
+    .PCPlus4W_i(PCPlus4W),
+    .ResultSrc_i(ResultSrcW),
+
+    .ResultW_o(ResultW)
+);
+
+//------------------------------------------------------------ hazards
+//decode reads a register a deferred load hasn't written yet, or the one deferring in memory now
+logic PendingD;
+assign PendingD = ((Rs1D != 5'b0) && (DPendingM[Rs1D] || (DDeferM && (RdM == Rs1D))))
+               || ((Rs2D != 5'b0) && (DPendingM[Rs2D] || (DDeferM && (RdM == Rs2D))));
+
+//the single cycle core has nothing to forward, and its pipe_regs are wires so the forwarding muxes would close a loop
+generate
+    if (PIPELINED) begin : pipeline
+        logic [1:0] ForwardAE;
+        logic [1:0] ForwardBE;
+        logic       ForwardAD;
+        logic       ForwardBD;
+
+        hazard_unit hazard_unit(
+            .Rs1D_i(Rs1D),
+            .Rs2D_i(Rs2D),
+            .Rs1E_i(Rs1E),
+            .Rs2E_i(Rs2E),
+            .RdE_i(RdE),
+            .RdM_i(RdM),
+            .RdW_i(RdW),
+            .LoadE_i(ResultSrcE == 2'b01),
+            .RegWriteM_i(RegWriteM),
+            .RegWriteW_i(RegWriteW),
+            .RedirectE_i(RedirectE),
+            .MemStallM_i(MemStallM),
+            .PendingD_i(PendingD),
+
+            .ForwardAE_o(ForwardAE),
+            .ForwardBE_o(ForwardBE),
+            .ForwardAD_o(ForwardAD),
+            .ForwardBD_o(ForwardBD),
+            .StallF_o(StallF),
+            .StallD_o(StallD),
+            .FlushD_o(FlushD),
+            .FlushE_o(FlushE)
+        );
+
+        //the register file writes at the edge that ends writeback, so decode takes the value straight from writeback
+        assign RD1D = ForwardAD ? ResultW : RFData1D;
+        assign RD2D = ForwardBD ? ResultW : RFData2D;
 
-    .ResultW_o(ResultW),
-    .RdW_o(RdW)
+        always_comb begin
+            case (ForwardAE)
+                2'b10:   FwdRD1E = ResultM;
+                2'b01:   FwdRD1E = ResultW;
+                default: FwdRD1E = RD1E;
+            endcase
+            case (ForwardBE)
+                2'b10:   FwdRD2E = ResultM;
+                2'b01:   FwdRD2E = ResultW;
+                default: FwdRD2E = RD2E;
+            endcase
+        end
+    end
+    else begin : single_cycle
+        assign RD1D = RFData1D;
+        assign RD2D = RFData2D;
+        assign FwdRD1E = RD1E;
+        assign FwdRD2E = RD2E;
+        assign StallF = MemStallM;
+        assign StallD = 1'b0;
+        assign FlushD = 1'b0;
+        assign FlushE = 1'b0;
+    end
+endgenerate
+
+//harness instrumentation from here to coverage_on, kept out of coverage and the toggle-based energy estimate
+/*verilator coverage_off*/
+
+//performance counters and halt probe, read by the harnesses through verilator public
+//counting stops when the halt loop's branch/jump first reaches writeback, so mcycle is cycles-to-halt and
+//minstret counts every instruction that retired before it, bubbles excluded
+//mloads/mstores count data memory accesses for the harness telemetry
+//mbp_lookups counts the branches and jumps that reached execute, mbp_hits those of them the predictor had a target for
+//and mbp_mispredicts the redirects, which is every taken one on the single cycle core
+//mic_hits counts the instructions fetched from the instruction cache, mic_misses its refills and mic_stalls
+//the cycles fetch waited on them, all zero without a cache
+//mdc_accesses counts the loads/stores the data cache completed, mdc_misses and mdc_writebacks the misses and the
+//dirty lines they evicted and mdc_stalls the cycles the core held for them, all zero without a cache,
+//mdc_victim_hits the misses in the sets the victim cache turned into a one cycle swap (not counted in mdc_misses)
+//mdc_deferred counts the load misses the pipelined core went on past (DCACHE_MSHRS) and mdc_pending_stalls the cycles
+//decode waited for one of them to return, both zero with a blocking cache
+//mpf_prefetches counts the lines the prefetcher filled and mpf_useful those a load/store then hit before they were
+//evicted, zero without a prefetcher
+//msb_forwards counts the loads the store buffer answered and msb_stalls the cycles the core held for it (full, a load
+//partly overlapping buffered stores, or a fence draining it), both zero without one
+//a held instruction is counted once, when it moves on
+logic [63:0]    mcycle /*verilator public*/;
+logic [63:0]    minstret /*verilator public*/;
+logic [63:0]    mloads /*verilator public*/;
+logic [63:0]    mstores /*verilator public*/;
+logic [63:0]    mbp_lookups /*verilator public*/;
+logic [63:0]    mbp_hits /*verilator public*/;
+logic [63:0]    mbp_mispredicts /*verilator public*/;
+logic [63:0]    mic_hits /*verilator public*/;
+logic [63:0]    mic_misses /*verilator public*/;
+logic [63:0]    mic_stalls /*verilator public*/;
+logic [63:0]    mdc_accesses /*verilator public*/;
+logic [63:0]    mdc_misses /*verilator public*/;
+logic [63:0]    mdc_writebacks /*verilator public*/;
+logic [63:0]    mdc_stalls /*verilator public*/;
+logic [63:0]    mdc_victim_hits /*verilator public*/;
+logic [63:0]    mdc_deferred /*verilator public*/;
+logic [63:0]    mdc_pending_stalls /*verilator public*/;
+logic [63:0]    mpf_prefetches /*verilator public*/;
+logic [63:0]    mpf_useful /*verilator public*/;
+logic [63:0]    msb_forwards /*verilator public*/;
+logic [63:0]    msb_stalls /*verilator public*/;
+logic           halted /*verilator public*/;
+logic           pipelined /*verilator public*/;
+
+assign pipelined = (PIPELINED != 0);
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst) begin
+        mcycle <= 64'b0;
+        minstret <= 64'b0;
+        mloads <= 64'b0;
+        mstores <= 64'b0;
+        mbp_lookups <= 64'b0;
+        mbp_hits <= 64'b0;
+        mbp_mispredicts <= 64'b0;
+        mic_hits <= 64'b0;
+        mic_misses <= 64'b0;
+        mic_stalls <= 64'b0;
+        mdc_accesses <= 64'b0;
+        mdc_misses <= 64'b0;
+        mdc_writebacks <= 64'b0;
+        mdc_stalls <= 64'b0;
+        mdc_victim_hits <= 64'b0;
+        mdc_deferred <= 64'b0;
+        mdc_pending_stalls <= 64'b0;
+        mpf_prefetches <= 64'b0;
+        mpf_useful <= 64'b0;
+        msb_forwards <= 64'b0;
+        msb_stalls <= 64'b0;
+        halted <= 1'b0;
+    end
+    else if (!halted) begin
+        mcycle <= mcycle + 64'd1;
+        if (validW && !haltW && !MemStallM)
+            minstret <= minstret + 64'd1;
+        if (ResultSrcM == 2'b01 && !MemStallM)
+            mloads <= mloads + 64'd1;
+        if (MemWriteM && !MemStallM)
+            mstores <= mstores + 64'd1;
+        if (UpdateE)
+            mbp_lookups <= mbp_lookups + 64'd1;
+        if (UpdateE && PredHitE)
+            mbp_hits <= mbp_hits + 64'd1;
+        if (RedirectE && !MemStallM)
+            mbp_mispredicts <= mbp_mispredicts + 64'd1;
+        if (ICACHE_BYTES > 0 && validF && !StallF)
+            mic_hits <= mic_hits + 64'd1;
+        if (IMissF)
+            mic_misses <= mic_misses + 64'd1;
+        if (!validF)
+            mic_stalls <= mic_stalls + 64'd1;
+        if (DAccessM)
+            mdc_accesses <= mdc_accesses + 64'd1;
+        if (DMissM)
+            mdc_misses <= mdc_misses + 64'd1;
+        if (DWritebackM)
+            mdc_writebacks <= mdc_writebacks + 64'd1;
+        if (MemStallM && !SbStallM && !IoStallM)
+            mdc_stalls <= mdc_stalls + 64'd1;
+        if (DVictimHitM)
+            mdc_victim_hits <= mdc_victim_hits + 64'd1;
+        if (DDeferM)
+            mdc_deferred <= mdc_deferred + 64'd1;
+        if (PendingD && !RedirectE && !MemStallM)
+            mdc_pending_stalls <= mdc_pending_stalls + 64'd1;
+        if (DPrefetchM)
+            mpf_prefetches <= mpf_prefetches + 64'd1;
+        if (DPrefetchHitM)
+            mpf_useful <= mpf_useful + 64'd1;
+        if (SbForwardM)
+            msb_forwards <= msb_forwards + 64'd1;
+        if (SbStallM)
+            msb_stalls <= msb_stalls + 64'd1;
+        if (validW && haltW && !MemStallM)
+            halted <= 1'b1;
+    end
+end
+
+//stage probes for the Kanata pipeline log (tb/common/kanata.h), index 0-4 is fetch, decode, execute, memory, writeback
+//probe_id numbers instructions in fetch order and moves down the stages with its instruction, probe_valid is low for a bubble
+//the probe pc/id registers follow the stalls and flushes of the pipeline registers, in the single cycle core
+//the same instruction is in every stage and a new one is fetched every cycle
+logic [4:0]             probe_valid /*verilator public*/;
+logic [DATA_WIDTH-1:0]  probe_pc [5] /*verilator public*/;
+logic [31:0]            probe_id [5] /*verilator public*/;
+logic [31:0]            fetch_id;
+
+always_ff @(posedge clk or posedge rst) begin
+    if (rst)
+        fetch_id <= 32'b0;
+    else if (!StallF && (validF || RedirectE))
+        fetch_id <= fetch_id + 32'd1;
+end
+
+assign probe_valid = {validW, validM, validE, validD, 1'b1} & {5{!rst}};
+assign probe_pc[0] = PCF;
+assign probe_id[0] = fetch_id;
+
+generate
+    if (PIPELINED) begin : probe_regs
+        logic [DATA_WIDTH-1:0]  pc_q [1:4];
+        logic [31:0]            id_q [1:4];
+
+        always_ff @(posedge clk or posedge rst) begin
+            if (rst) begin
+                for (int stage = 1; stage < 5; stage++) begin
+                    pc_q[stage] <= '0;
+                    id_q[stage] <= 32'b0;
+                end
+            end
+            else begin
+                if (FlushD) begin
+                    pc_q[1] <= '0;
+                    id_q[1] <= 32'b0;
+                end
+                else if (!StallD) begin
+                    pc_q[1] <= PCF;
+                    id_q[1] <= fetch_id;
+                end
+                if (!MemStallM) begin
+                    pc_q[2] <= FlushE ? '0 : pc_q[1];
+                    id_q[2] <= FlushE ? 32'b0 : id_q[1];
+                    for (int stage = 3; stage < 5; stage++) begin
+                        pc_q[stage] <= pc_q[stage-1];
+                        id_q[stage] <= id_q[stage-1];
+                    end
+                end
+            end
+        end
+
+        for (genvar stage = 1; stage < 5; stage++) begin : stages
+            assign probe_pc[stage] = pc_q[stage];
+            assign probe_id[stage] = id_q[stage];
+        end
+    end
+    else begin : probe_wires
+        for (genvar stage = 1; stage < 5; stage++) begin : stages
+            assign probe_pc[stage] = PCF;
+            assign probe_id[stage] = fetch_id;
+        end
+    end
+endgenerate
+
+/*verilator coverage_on*/
+
+`ifdef COVERAGE
+//functional cover points for the coverage build, see coverpoints.sv
+//sampled in execute, where the branch outcome and the memory address of an instruction are both known
+logic [DATA_WIDTH-1:0] InstrE;
+
+pipe_reg #(
+    .WIDTH(DATA_WIDTH),
+    .BYPASS(!PIPELINED)
+) cover_reg(
+    .clk(clk),
+    .rst(rst),
+    .en_i(!MemStallM),
+    .clear_i(FlushE),
+    .d_i(InstrD),
+    .q_o(InstrE)
+);
+
+coverpoints coverpoints(
+    .clk(clk),
+    .rst(rst),
+    .valid_i(validE && !MemStallM),
+    .Instr_i(InstrE),
+    .ALUCtrl_i(ALUCtrlE),
+    .MemType_i(MemTypeE),
+    .MemSign_i(MemSignE),
+    .addr_i(ALUResultE),
+    .branchTaken_i(branchTakenE)
 );
+`endif
 
 endmodule
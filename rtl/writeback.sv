@@ -5,11 +5,8 @@ module writeback #(
     input logic [DATA_WIDTH-1:0] ReadDataW_i,
     input logic [DATA_WIDTH-1:0] PCPlus4W_i,
     input logic [1:0] ResultSrc_i,
-    input logic [4:0] RdM_i,
-
-    output logic [DATA_WIDTH-1:0] ResultW_o,
-    output logic [4:0] RdW_o
 
+    output logic [DATA_WIDTH-1:0] ResultW_o
 );
 
 //this is equivalent to a mux
@@ -22,7 +19,4 @@ always_comb begin
     endcase
 end
 
-assign RdW_o = RdM_i; //this is the blue line that we added
-
-
 endmodule
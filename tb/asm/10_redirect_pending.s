@@ -0,0 +1,22 @@
+.text
+.globl main
+# A load that misses the data cache, then a taken branch with an instruction
+# behind it that reads the load's register. With DCACHE_MSHRS the load goes on
+# without its data, so decode waits on it in the cycle the branch redirects.
+# The redirect must still be taken, the waiting instruction is flushed.
+main:
+    li      s0, 0x00010000      # base of the data array, not cached yet
+    lw      t0, 0(s0)           # misses
+    beq     zero, zero, taken   # taken, predicted not taken the first time
+    add     t1, t0, t0          # wrong path, reads the missing load's t0
+    li      a0, 1               # wrong path result
+    bne     a0, zero, finish
+
+taken:
+    lw      t2, 0(s0)           # the same word again, t0 must match it
+    sub     t3, t0, t2
+    addi    a0, t3, 42          # a0 = 42
+    bne     a0, zero, finish    # enter finish state
+
+finish:     # expected result is 42
+    bne     a0, zero, finish    # loop forever
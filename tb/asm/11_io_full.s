@@ -0,0 +1,16 @@
+.text
+.globl main
+.equ io_out, -256               # 0xFFFFFF00, output fifo (rtl/io_port.sv)
+# streams 1 to 24 out of the output fifo, more than its 16 words, so with
+# out_ready low the store that finds it full waits until a word leaves.
+# Halts with a0 = number of words pushed
+main:
+    LI      a1, 1                   # a1 = next word
+    LI      a2, 25                  # a2 = last word + 1
+_loop:                              # repeat
+    SW      a1, io_out(zero)        #     push a1
+    ADDI    a1, a1, 1               #     next word
+    BNE     a1, a2, _loop           # until a1 = 25
+    ADDI    a0, a1, -1              # a0 = 24
+finish:
+    J       finish
@@ -3,6 +3,7 @@
 .equ base_pdf, 0x100
 .equ base_data, 0x10000
 .equ max_count, 200
+.equ io_out, -256               # 0xFFFFFF00, output fifo (rtl/io_port.sv)
 # this is a modified version of the pdf program that returns the sum
 # of the value of all the bins
 # default distribution is gaussian
@@ -42,6 +43,7 @@ display:    # function send PDF array value to a0 for display
     LI      a2, 255             # a2 = max index of pdf array
 _loop3:                         # repeat
     LBU     a0, base_pdf(a1)    #   a0 = mem[base_pdf+a1)
+    SW      a0, io_out(zero)    #   stream the bin to the harness
     ADD     s1, s1, a0          #   s1 += mem[base_pdf+a1)
     ADDI    a1, a1, 1           #   incr
     BNE     a1, a2, _loop3      # until end of pdf array
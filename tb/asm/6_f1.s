@@ -1,7 +1,11 @@
 .text
 .globl main
+.equ io_out, -256                  # 0xFFFFFF00, output fifo (rtl/io_port.sv)
+.equ io_trigger, -252              # 0xFFFFFF04, trigger latch, reading clears it
 
 main:
+    lw      t0, io_trigger(zero)   # wait for the start button
+    beqz    t0, main
     mv      a0, zero               # start state a0 at 0
     mv      a2, zero               # clear cmd_delay
     mv      a3, zero               # clear cmd_seq
@@ -17,6 +21,7 @@ delay_loop:
 
     slli    a0, a0, 1              # shift state left
     ori     a0, a0, 1              # add the 1 bit at the end
+    sw      a0, io_out(zero)       # show the new state
     bne     a0, t1, state_output   # if not full, go to output
 
 state_S8:
@@ -38,6 +43,7 @@ random_delay:
     bnez    t5, random_delay
 
     mv      a0, zero               # reset state
+    sw      a0, io_out(zero)       # lights out
     j       shift_loop             # start over
 
 state_output:
@@ -0,0 +1,23 @@
+.text
+.globl main
+# countdown delay loops like the ones in 6_f1.s, which the harness skips
+# analytically (see common/loop_skip.h)
+main:
+    li      a0, 0               # a0 = number of delays done
+    li      t0, 3               # t0 = delays left
+outer:
+    li      t1, 1000            # step -1 delay
+delay:
+    addi    t1, t1, -1
+    bnez    t1, delay
+    li      t2, 600             # step -2 delay
+delay2:
+    addi    t2, t2, -2
+    bnez    t2, delay2
+    addi    a0, a0, 1           # a0++
+    addi    t0, t0, -1
+    bnez    t0, outer           # not a self loop, never skipped
+    bne     a0, zero, finish    # enter finish state
+
+finish:     # expected result is 3
+    bne     a0, zero, finish    # loop forever
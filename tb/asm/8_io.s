@@ -0,0 +1,18 @@
+.text
+.globl main
+.equ io_out, -256               # 0xFFFFFF00, output fifo (rtl/io_port.sv)
+.equ io_trigger, -252           # 0xFFFFFF04, trigger latch, reading clears it
+# waits for the trigger input, streams 1 to 5 out of the output fifo, then
+# halts with a0 = number of words still waiting in the fifo
+main:
+    LW      t0, io_trigger(zero)    # repeat
+    BEQZ    t0, main                # until triggered
+    LI      a1, 1                   # a1 = next word
+    LI      a2, 6                   # a2 = last word + 1
+_loop:                              # repeat
+    SW      a1, io_out(zero)        #     push a1
+    ADDI    a1, a1, 1               #     next word
+    BNE     a1, a2, _loop           # until a1 = 6
+    LW      a0, io_out(zero)        # a0 = fifo level
+finish:
+    J       finish
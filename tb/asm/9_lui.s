@@ -0,0 +1,14 @@
+.text
+.globl main
+# lui has no rs1, bits [19:15] of the instruction are part of its immediate.
+# Each lui below names a nonzero register there, which must not be added in.
+main:
+    li      s0, 0x700           # x8 = 0x700
+    li      t6, 5               # x31 = 5
+    lui     a0, 0x12345         # bits [19:15] = 8, a0 = 0x12345000
+    lui     a1, 0xFFFFF         # bits [19:15] = 31, a1 = 0xFFFFF000
+    add     a0, a0, a1          # a0 = 0x12344000
+    bne     a0, zero, finish    # enter finish state
+
+finish:     # expected result is 0x12344000
+    bne     a0, zero, finish    # loop forever
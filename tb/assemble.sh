@@ -1,6 +1,7 @@
 #!/bin/bash
 
-# Usage: ./assemble.sh <file.s>
+# Usage: ./assemble.sh <file.s> [output folder]
+# Without an output folder program.hex goes to tb/ and the disassembly to tb/test_out/<name>
 
 # Default vars
 SCRIPT_DIR=$(dirname "$(realpath "$0")")
@@ -18,6 +19,11 @@ parent=$(dirname "$input_file")
 file_extension="${input_file##*.}"
 LOG_DIR="$SCRIPT_DIR/test_out/$basename"
 
+if [[ $# -ge 2 ]]; then
+    LOG_DIR="$2"
+    output_file="$2/program.hex"
+fi
+
 # Create output directory for disassembly, hex and waveforms
 mkdir -p $LOG_DIR
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "verilated.h"
+
+#ifdef COVERAGE
+#include "verilated_cov.h"
+#endif
+
+// Coverage hooks for the harnesses. In the coverage build (COVERAGE=1 ./doit.sh,
+// or -DRISKV_COVERAGE=ON with CMake) the models are verilated with --coverage
+// and every test writes its own database, which coverage/covmerge merges.
+// Otherwise these compile to nothing.
+
+// Writes the counters of every model in context to path, creating its folder.
+// clear drops the points afterwards so the next model in the same context
+// starts from zero instead of reporting a deleted model's counters.
+inline void writeCoverage(VerilatedContext* context, const std::string &path, bool clear = false)
+{
+#ifdef COVERAGE
+    std::filesystem::path file(path);
+    if (file.has_parent_path()) std::filesystem::create_directories(file.parent_path());
+    context->coveragep()->write(path.c_str());
+    if (clear) context->coveragep()->clear();
+#else
+    (void)context;
+    (void)path;
+    (void)clear;
+#endif
+}
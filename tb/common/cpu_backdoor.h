@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Vdut.h"
+#include "Vdut___024root.h"
+
+#ifdef SPARSE_MEM
+#include "sparse_mem.h"
+#endif
+
+// Backdoor access to the architectural state of the verilated top, through
+// the signals marked /*verilator public*/ in the RTL. Member names follow the
+// instance hierarchy in top.sv, so this is the one place to update if it moves.
+//
+// Data writes go to data_mem directly, behind the data cache when top has
+// one. Reads see a dirty line of the cache (or of its victim cache) first, so
+// they return what the core would load. A store buffer is drained by the time
+// the core halts, but not mid-run.
+//
+// Writes bypass Verilator's scheduling: make them while the core is held in
+// reset and call resync() before releasing it. loop_skip.h is the exception,
+// it writes mid-run where the stale combinational values are harmless.
+class CpuBackdoor
+{
+public:
+    static constexpr uint32_t ROM_BASE = 0xBFC00000;
+    // as deep as instrmem's rom_mem, 2**IMEM_ADDR_BITS bytes
+    static constexpr uint32_t ROM_BYTES =
+        sizeof(Vdut___024root::top__DOT__fetch__DOT__instruction_memory__DOT__rom_mem) / sizeof(CData);
+
+    explicit CpuBackdoor(Vdut* top) : top_(top), root_(top->rootp) {}
+
+    uint32_t pc() const { return root_->top__DOT__fetch__DOT__PC; }
+
+    uint32_t reg(unsigned index) const { return index ? uint32_t(regs()[index]) : 0; }
+    void setReg(unsigned index, uint32_t value)
+    {
+        if (index) regs()[index] = value;
+    }
+    void clearRegs()
+    {
+        for (unsigned i = 0; i < 32; i++) regs()[i] = 0;
+    }
+
+    // Performance counters and halt probe in top.sv
+    uint64_t cycles() const { return root_->top__DOT__mcycle; }
+    uint64_t instret() const { return root_->top__DOT__minstret; }
+    uint64_t loads() const { return root_->top__DOT__mloads; }
+    uint64_t stores() const { return root_->top__DOT__mstores; }
+    uint64_t bpLookups() const { return root_->top__DOT__mbp_lookups; }
+    uint64_t bpHits() const { return root_->top__DOT__mbp_hits; }
+    uint64_t bpMispredicts() const { return root_->top__DOT__mbp_mispredicts; }
+    // top built with ICACHE_BYTES above 0, whose refills make cycle counts depend on the cache
+    static constexpr bool hasIcache() { return HasIcache<Vdut___024root>::value; }
+    // all zero when top has no instruction cache
+    uint64_t icacheHits() const { return root_->top__DOT__mic_hits; }
+    uint64_t icacheMisses() const { return root_->top__DOT__mic_misses; }
+    uint64_t icacheStalls() const { return root_->top__DOT__mic_stalls; }
+    // top built with DCACHE_BYTES above 0, whose misses and refills make cycle counts depend on the cache
+    static constexpr bool hasDcache() { return HasDcache<Vdut___024root>::value; }
+    // all zero when top has no data cache
+    uint64_t dcacheAccesses() const { return root_->top__DOT__mdc_accesses; }
+    uint64_t dcacheMisses() const { return root_->top__DOT__mdc_misses; }
+    uint64_t dcacheWritebacks() const { return root_->top__DOT__mdc_writebacks; }
+    uint64_t dcacheStalls() const { return root_->top__DOT__mdc_stalls; }
+    uint64_t dcacheVictimHits() const { return root_->top__DOT__mdc_victim_hits; }
+    uint64_t dcacheDeferred() const { return root_->top__DOT__mdc_deferred; }
+    uint64_t dcachePendingStalls() const { return root_->top__DOT__mdc_pending_stalls; }
+    // both zero when top has no data prefetcher
+    uint64_t prefetches() const { return root_->top__DOT__mpf_prefetches; }
+    uint64_t prefetchesUseful() const { return root_->top__DOT__mpf_useful; }
+    // both zero when top has no store buffer
+    uint64_t storeBufferForwards() const { return root_->top__DOT__msb_forwards; }
+    uint64_t storeBufferStalls() const { return root_->top__DOT__msb_stalls; }
+    bool halted() const { return root_->top__DOT__halted; }
+    // top built with PIPELINED, the five stage core
+    bool pipelined() const { return root_->top__DOT__pipelined; }
+
+    // Stage probes in top.sv, stage 0-4 is fetch, decode, execute, memory,
+    // writeback. The id follows an instruction down the stages.
+    static constexpr unsigned STAGES = 5;
+    bool stageValid(unsigned stage) const { return (root_->top__DOT__probe_valid >> stage) & 1; }
+    uint32_t stagePc(unsigned stage) const { return root_->top__DOT__probe_pc[stage]; }
+    uint32_t stageId(unsigned stage) const { return root_->top__DOT__probe_id[stage]; }
+
+    // Accounts for cycles and instructions the harness skipped analytically
+    void addCounters(uint64_t cycles, uint64_t instret)
+    {
+        root_->top__DOT__mcycle += cycles;
+        root_->top__DOT__minstret += instret;
+    }
+
+    // Instruction word at pc, or 0 outside the ROM
+    uint32_t fetch(uint32_t pc) const
+    {
+        uint32_t offset = pc - ROM_BASE;
+        if (offset > ROM_BYTES - 4) return 0;
+        return rom()[offset] | (rom()[offset + 1] << 8) | (rom()[offset + 2] << 16) | (uint32_t(rom()[offset + 3]) << 24);
+    }
+
+    // Replaces the whole ROM image, zero filling past the end of the program
+    void loadRom(const std::vector<uint32_t> &words)
+    {
+        for (uint32_t offset = 0; offset < ROM_BYTES; offset++)
+        {
+            uint32_t index = offset >> 2;
+            rom()[offset] = index < words.size() ? (words[index] >> (8 * (offset & 3))) & 0xFF : 0;
+        }
+    }
+
+    uint8_t readData(uint32_t addr) const
+    {
+        uint8_t cached;
+        if (dirtyByte(root_, addr, cached)) return cached;
+#ifdef SPARSE_MEM
+        return sparseMem().read8(addr);
+#else
+        return ram()[addr & denseMask()];
+#endif
+    }
+
+    void writeData(uint32_t addr, uint8_t value)
+    {
+#ifdef SPARSE_MEM
+        sparseMem().write8(addr, value);
+#else
+        ram()[addr & denseMask()] = value;
+#endif
+    }
+
+    // Re-evaluates the logic that reads backdoor-written state by pulsing the
+    // asynchronous reset, without a clock edge that would commit stale values.
+    // Leaves the core held in reset.
+    void resync()
+    {
+        top_->rst = 0;
+        top_->eval();
+        top_->rst = 1;
+        top_->eval();
+    }
+
+    void clearData()
+    {
+#ifdef SPARSE_MEM
+        sparseMem().clear();
+#else
+        for (uint32_t addr = 0; addr <= denseMask(); addr++) ram()[addr] = 0;
+#endif
+    }
+
+private:
+    // top built with DCACHE_BYTES above 0, its arrays only exist then
+    template <typename Root, typename = void>
+    struct HasDcache : std::false_type {};
+    template <typename Root>
+    struct HasDcache<Root, std::void_t<decltype(&Root::top__DOT__memory__DOT__cache__DOT__dcache__DOT__lines)>>
+        : std::true_type {};
+    template <typename Root, typename = void>
+    struct HasIcache : std::false_type {};
+    template <typename Root>
+    struct HasIcache<Root, std::void_t<decltype(&Root::top__DOT__fetch__DOT__cache__DOT__icache__DOT__valid)>>
+        : std::true_type {};
+
+    // The byte at addr if a dirty line holds it, the geometry comes from the
+    // array sizes so any cache parameters work. Lines that aren't dirty match
+    // data_mem, and one being refilled is never dirty.
+    template <typename Root>
+    static bool dirtyByte(Root* root, uint32_t addr, uint8_t &value)
+    {
+        if constexpr (HasDcache<Root>::value)
+        {
+            auto &valid = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__valid;
+            auto &dirty = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__dirty;
+            auto &tags = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__tags;
+            auto &lines = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__lines;
+            const uint32_t ways = sizeof(tags) / sizeof(tags[0]);
+            const uint32_t sets = sizeof(tags[0]) / sizeof(tags[0][0]);
+            const uint32_t words = sizeof(lines[0][0]) / sizeof(lines[0][0][0]);
+            const uint32_t line = addr / (4 * words);
+            const uint32_t word = (addr / 4) % words;
+            const unsigned shift = 8 * (addr & 3);
+
+            for (uint32_t way = 0; way < ways; way++)
+            {
+                uint32_t set = line % sets;
+                if (valid[way][set] && dirty[way][set] && tags[way][set] == line / sets)
+                {
+                    value = lines[way][set][word] >> shift;
+                    return true;
+                }
+            }
+
+            auto &victim_valid = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__victim_valid;
+            auto &victim_dirty = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__victim_dirty;
+            auto &victim_tags = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__victim_tags;
+            auto &victim_lines = root->top__DOT__memory__DOT__cache__DOT__dcache__DOT__victim_lines;
+            for (uint32_t i = 0; i < sizeof(victim_tags) / sizeof(victim_tags[0]); i++)
+            {
+                if (victim_valid[i] && victim_dirty[i] && victim_tags[i] == line)
+                {
+                    value = victim_lines[i][word] >> shift;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    decltype(Vdut___024root::top__DOT__decode__DOT__regfile__DOT__regs) &regs() const
+    {
+        return root_->top__DOT__decode__DOT__regfile__DOT__regs;
+    }
+    decltype(Vdut___024root::top__DOT__fetch__DOT__instruction_memory__DOT__rom_mem) &rom() const
+    {
+        return root_->top__DOT__fetch__DOT__instruction_memory__DOT__rom_mem;
+    }
+#ifndef SPARSE_MEM
+    decltype(Vdut___024root::top__DOT__memory__DOT__datamem__DOT__data_mem__DOT__ram_array) &ram() const
+    {
+        return root_->top__DOT__memory__DOT__datamem__DOT__data_mem__DOT__ram_array;
+    }
+    // data_mem aliases on the low DMEM_ADDR_BITS address bits, as deep as the array
+    uint32_t denseMask() const { return sizeof(ram()) / sizeof(ram()[0]) - 1; }
+#endif
+
+    Vdut* top_;
+    Vdut___024root* root_;
+};
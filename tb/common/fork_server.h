@@ -0,0 +1,185 @@
+#pragma once
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Runs jobs in copy-on-write children of the calling process. The caller
+// builds and resets its model once, then submits jobs; each one forks a child
+// that starts from that exact state, injects its program and data through the
+// backdoor, runs, and returns a result string through a pipe. Nothing a job
+// does reaches the parent, so there is no reset or teardown between jobs and
+// a crashing job only loses itself. A runaway one does too when the server
+// has a deadline: a child still running job_seconds after it was forked is
+// killed and reported like a crash, without a deadline it holds its slot and
+// finish() waits on it for good.
+//
+// Up to max_children jobs run at once. Results are handed to on_result in the
+// parent, in completion order, from submit() and finish().
+class ForkServer
+{
+public:
+    struct Result
+    {
+        uint64_t id;
+        bool ok; // child exited normally with status 0
+        bool timed_out; // and if not, it was killed at the deadline
+        std::string data;
+    };
+
+    using Job = std::function<std::string()>;
+    using Callback = std::function<void(const Result &)>;
+
+    // job_seconds 0 is no deadline
+    ForkServer(unsigned max_children, Callback on_result, double job_seconds = 0)
+        : max_children_(max_children ? max_children : 1), on_result_(std::move(on_result)), job_seconds_(job_seconds)
+    {
+    }
+
+    ~ForkServer() { finish(); }
+
+    // Forks a child for job, waiting for a free slot first. Returns false if
+    // the child couldn't be started.
+    bool submit(uint64_t id, const Job &job)
+    {
+        while (children_.size() >= max_children_) collect();
+
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            perror("fork server: pipe");
+            return false;
+        }
+        // buffered output would otherwise be written again by every child
+        std::cout.flush();
+        std::cerr.flush();
+        fflush(nullptr);
+
+        auto start = std::chrono::steady_clock::now();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            for (const Child &child : children_)
+                if (child.fd >= 0) close(child.fd);
+            std::string data = job();
+            for (size_t done = 0; done < data.size();)
+            {
+                ssize_t n = write(fds[1], data.data() + done, data.size() - done);
+                if (n <= 0) _exit(3);
+                done += n;
+            }
+            // skip the destructors, the model belongs to the parent
+            _exit(0);
+        }
+        fork_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        close(fds[1]);
+        if (pid < 0)
+        {
+            perror("fork server: fork");
+            close(fds[0]);
+            return false;
+        }
+        forks_++;
+        children_.push_back({pid, fds[0], id, {}, start});
+        return true;
+    }
+
+    // Waits for every running job
+    void finish()
+    {
+        while (!children_.empty()) collect();
+    }
+
+    uint64_t forks() const { return forks_; }
+    // mean time the parent spends in fork(), the startup cost of a job
+    double meanForkMicros() const { return forks_ ? 1e6 * fork_seconds_ / forks_ : 0; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Child
+    {
+        pid_t pid;
+        int fd; // -1 once the pipe reached end of file
+        uint64_t id;
+        std::string data;
+        Clock::time_point started;
+    };
+
+    // Reads from the running children for one poll, and reaps the ones that
+    // exited or ran past the deadline. Polls again every millisecond while a
+    // child has closed its pipe but not exited yet, so no wait blocks.
+    void collect()
+    {
+        std::vector<pollfd> fds;
+        int timeout_ms = -1;
+        auto now = Clock::now();
+        for (const Child &child : children_)
+        {
+            // a negative fd is skipped by poll
+            fds.push_back({child.fd, POLLIN, 0});
+            if (child.fd < 0) timeout_ms = 1;
+            if (job_seconds_ > 0)
+            {
+                double left = job_seconds_ - std::chrono::duration<double>(now - child.started).count();
+                int left_ms = left > 0 ? int(left * 1000) + 1 : 0;
+                timeout_ms = timeout_ms < 0 ? left_ms : std::min(timeout_ms, left_ms);
+            }
+        }
+        if (poll(fds.data(), fds.size(), timeout_ms) < 0) return;
+
+        now = Clock::now();
+        for (size_t i = fds.size(); i-- > 0;)
+        {
+            Child &child = children_[i];
+            if (fds[i].revents)
+            {
+                char buf[4096];
+                ssize_t n = read(child.fd, buf, sizeof(buf));
+                if (n > 0)
+                {
+                    child.data.append(buf, n);
+                    continue;
+                }
+                // end of file, the child is about to exit
+                close(child.fd);
+                child.fd = -1;
+            }
+
+            int status = 0;
+            bool exited = child.fd < 0 && waitpid(child.pid, &status, WNOHANG) == child.pid;
+            bool timed_out = !exited && job_seconds_ > 0 &&
+                             std::chrono::duration<double>(now - child.started).count() >= job_seconds_;
+            if (!exited && !timed_out) continue;
+            if (timed_out)
+            {
+                kill(child.pid, SIGKILL);
+                waitpid(child.pid, &status, 0);
+                if (child.fd >= 0) close(child.fd);
+            }
+
+            bool ok = !timed_out && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            Result result{child.id, ok, timed_out, std::move(child.data)};
+            children_.erase(children_.begin() + i);
+            on_result_(result);
+        }
+    }
+
+    unsigned max_children_;
+    Callback on_result_;
+    double job_seconds_;
+    std::vector<Child> children_;
+    uint64_t forks_ = 0;
+    double fork_seconds_ = 0;
+};
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "fork_server.h"
+
+TEST(ForkServerTest, ReturnsEveryResult)
+{
+    std::map<uint64_t, std::string> results;
+    ForkServer server(4, [&](const ForkServer::Result &result) {
+        EXPECT_TRUE(result.ok);
+        results[result.id] = result.data;
+    });
+    for (uint64_t i = 0; i < 50; i++) server.submit(i, [i]() { return "job " + std::to_string(i); });
+    server.finish();
+
+    ASSERT_EQ(results.size(), 50);
+    EXPECT_EQ(results[0], "job 0");
+    EXPECT_EQ(results[49], "job 49");
+    EXPECT_EQ(server.forks(), 50);
+}
+
+TEST(ForkServerTest, ChildrenStartFromTheParentState)
+{
+    // every child sees the value the parent had when it forked, and nothing a
+    // child writes comes back
+    std::vector<int> state(1000, 7);
+    int sum = 0;
+    ForkServer server(2, [&](const ForkServer::Result &result) { sum += std::stoi(result.data); });
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        server.submit(i, [&state]() {
+            int first = state[0];
+            state.assign(state.size(), 0);
+            return std::to_string(first);
+        });
+    }
+    server.finish();
+    EXPECT_EQ(sum, 70);
+    EXPECT_EQ(state[999], 7);
+}
+
+TEST(ForkServerTest, LargeResultsArriveWhole)
+{
+    // bigger than a pipe buffer, so the parent has to drain while the child writes
+    std::string data;
+    ForkServer server(1, [&](const ForkServer::Result &result) { data = result.data; });
+    server.submit(0, []() { return std::string(1 << 20, 'x'); });
+    server.finish();
+    EXPECT_EQ(data.size(), 1u << 20);
+}
+
+TEST(ForkServerTest, CrashedJobIsReported)
+{
+    std::map<uint64_t, bool> ok;
+    ForkServer server(2, [&](const ForkServer::Result &result) { ok[result.id] = result.ok; });
+    server.submit(0, []() -> std::string { abort(); });
+    server.submit(1, []() { return std::string("fine"); });
+    server.finish();
+    EXPECT_FALSE(ok[0]);
+    EXPECT_TRUE(ok[1]);
+}
+
+TEST(ForkServerTest, RunawayJobIsKilledAtTheDeadline)
+{
+    std::map<uint64_t, ForkServer::Result> results;
+    ForkServer server(2, [&](const ForkServer::Result &result) { results[result.id] = result; }, 0.2);
+    auto start = std::chrono::steady_clock::now();
+    server.submit(0, []() -> std::string {
+        for (;;) pause();
+    });
+    server.submit(1, []() { return std::string("fine"); });
+    server.finish();
+    EXPECT_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 5.0);
+    EXPECT_FALSE(results[0].ok);
+    EXPECT_TRUE(results[0].timed_out);
+    EXPECT_TRUE(results[1].ok);
+    EXPECT_FALSE(results[1].timed_out);
+    EXPECT_EQ(results[1].data, "fine");
+}
+
+TEST(ForkServerTest, ClosedPipeDoesNotBlockTheServer)
+{
+    // the pipe reaches end of file long before the child exits
+    bool ok = true;
+    ForkServer server(1, [&](const ForkServer::Result &result) { ok = result.ok; }, 0.2);
+    server.submit(0, []() -> std::string {
+        for (int fd = 3; fd < 256; fd++) close(fd);
+        for (;;) pause();
+    });
+    server.finish();
+    EXPECT_FALSE(ok);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cpu_backdoor.h"
+#include "rv32i.h"
+
+// Writes a Kanata log (the format the Konata pipeline viewer reads) from the
+// stage probes in top.sv: one row per instruction, showing the cycles it
+// spent in each stage, bubbles as gaps, and whether it retired or was flushed.
+//
+// Only cycles first .. first + count - 1 are logged. Call cycle() before every
+// clock edge; outside the window it is one comparison. Cycles are numbered
+// like mcycle, and logging stops at the halt loop since mcycle freezes there.
+class KanataLog
+{
+public:
+    KanataLog(Vdut* top, const std::string &path, uint64_t first, uint64_t count)
+        : backdoor_(top), path_(path), first_(first), last_(first + count - 1)
+    {
+    }
+
+    ~KanataLog() { close(); }
+
+    // Logs what every stage holds during this cycle
+    void cycle(uint64_t cycle)
+    {
+        if (cycle < first_ || closed_) return;
+        if (cycle > last_ || backdoor_.halted())
+        {
+            close();
+            return;
+        }
+        if (!file_.is_open())
+        {
+            file_.open(path_);
+            file_ << "Kanata\t0004\nC=\t" << cycle << "\n";
+        }
+        else file_ << "C\t" << cycle - last_cycle_ << "\n";
+        last_cycle_ = cycle;
+
+        for (unsigned stage = 0; stage < CpuBackdoor::STAGES; stage++)
+        {
+            if (!backdoor_.stageValid(stage)) continue;
+            uint32_t id = backdoor_.stageId(stage);
+            auto it = live_.find(id);
+            if (it == live_.end())
+            {
+                uint32_t pc = backdoor_.stagePc(stage);
+                it = live_.emplace(id, Entry{next_++, -1, cycle}).first;
+                file_ << "I\t" << it->second.row << "\t" << id << "\t0\n";
+                file_ << "L\t" << it->second.row << "\t0\t" << hex(pc) << ": "
+                      << rv32i::disasm(backdoor_.fetch(pc)) << "\n";
+            }
+            Entry &entry = it->second;
+            if (entry.stage != int(stage)) file_ << "S\t" << entry.row << "\t0\t" << STAGE_NAMES[stage] << "\n";
+            entry.stage = stage;
+            entry.seen = cycle;
+        }
+
+        // instructions that left the pipeline: retired out of writeback,
+        // flushed from anywhere else
+        for (auto it = live_.begin(); it != live_.end();)
+        {
+            if (it->second.seen == cycle)
+            {
+                ++it;
+                continue;
+            }
+            end(it->second);
+            it = live_.erase(it);
+        }
+    }
+
+    // Loop skipping must not jump into or across the window
+    uint64_t skippable(uint64_t cycle) const
+    {
+        if (closed_ || cycle > last_) return std::numeric_limits<uint64_t>::max();
+        return cycle < first_ ? first_ - cycle : 0;
+    }
+
+private:
+    static constexpr const char* STAGE_NAMES[CpuBackdoor::STAGES] = {"F", "D", "X", "M", "W"};
+
+    struct Entry
+    {
+        uint64_t row; // instruction id in the log
+        int stage;
+        uint64_t seen;
+    };
+
+    void end(const Entry &entry)
+    {
+        bool retired = entry.stage == int(CpuBackdoor::STAGES - 1);
+        file_ << "R\t" << entry.row << "\t" << (retired ? retired_++ : 0) << "\t" << (retired ? 0 : 1) << "\n";
+    }
+
+    void close()
+    {
+        if (closed_) return;
+        closed_ = true;
+        if (!file_.is_open()) return;
+        // whatever is still in flight ends with the window
+        file_ << "C\t1\n";
+        for (const auto &entry : live_) end(entry.second);
+        live_.clear();
+        file_.close();
+    }
+
+    static std::string hex(uint32_t value)
+    {
+        char buf[9];
+        snprintf(buf, sizeof(buf), "%08x", value);
+        return buf;
+    }
+
+    CpuBackdoor backdoor_;
+    std::string path_;
+    uint64_t first_;
+    uint64_t last_;
+    std::ofstream file_;
+    bool closed_ = false;
+    uint64_t last_cycle_ = 0;
+    uint64_t next_ = 0;
+    uint64_t retired_ = 0;
+    std::unordered_map<uint32_t, Entry> live_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "cpu_backdoor.h"
+#include "rv32i.h"
+
+// Skips counted busy-wait loops of the form
+//
+//     loop: addi r, r, -step
+//           bnez r, loop
+//
+// by jumping r and the cycle/instruction counters straight to the last
+// iteration. The harness calls trySkip() after every cycle. When the fetch PC
+// is on the branch of such a loop, the skipper waits for one more iteration to
+// measure its period in cycles (so it stays exact whatever the branch costs),
+// then rewrites r and adds the skipped cycles to mcycle and minstret. The core
+// runs the final iteration itself and leaves the loop as usual.
+//
+// The rewrite happens with the core on the branch: the branch still sees the
+// old, nonzero r and is taken, which is also the right outcome for the new
+// one, and it writes no register. Loops whose count isn't a multiple of the
+// step, or that are left in any other way, are never skipped.
+class LoopSkipper
+{
+public:
+    explicit LoopSkipper(Vdut* top) : backdoor_(top) {}
+
+    // Skips at most budget cycles of the loop the core is in, returns how many
+    // it skipped (0 when it's not in a countdown loop).
+    uint64_t trySkip(uint64_t budget)
+    {
+        // in the five stage core the register file lags fetch and the loop's
+        // own addi is in flight, so a rewrite would be lost or clobbered
+        if (backdoor_.pipelined()) return 0;
+
+        uint32_t pc = backdoor_.pc();
+        // anything but the loop's own two instructions forgets the history
+        if (seen_ && pc != last_pc_ && pc != last_pc_ - 4) seen_ = false;
+
+        unsigned reg;
+        uint32_t step;
+        if (!countdownBranch(pc, reg, step)) return 0;
+
+        uint32_t value = backdoor_.reg(reg);
+        uint64_t now = backdoor_.cycles();
+        bool steady = seen_ && last_pc_ == pc && last_value_ - value == step;
+        uint64_t period = now - last_cycle_;
+        seen_ = true;
+        last_pc_ = pc;
+        last_value_ = value;
+        last_cycle_ = now;
+        if (!steady || period == 0 || value == 0 || value % step != 0) return 0;
+
+        // leave the last iteration to the core
+        uint64_t iterations = std::min<uint64_t>(value / step - 1, budget / period);
+        if (iterations == 0) return 0;
+
+        last_value_ = value - uint32_t(iterations) * step;
+        last_cycle_ = now + iterations * period;
+        backdoor_.setReg(reg, last_value_);
+        backdoor_.addCounters(iterations * period, iterations * 2);
+
+        loops_++;
+        skipped_ += iterations * period;
+        return iterations * period;
+    }
+
+    uint64_t loops() const { return loops_; }
+    uint64_t skippedCycles() const { return skipped_; }
+
+private:
+    // bnez r, pc-4 preceded by addi r, r, -step
+    bool countdownBranch(uint32_t pc, unsigned &reg, uint32_t &step) const
+    {
+        uint32_t branch = backdoor_.fetch(pc);
+        if (rv32i::opcode(branch) != rv32i::OP_BRANCH || rv32i::funct3(branch) != 1 || rv32i::immB(branch) != -4)
+            return false;
+        reg = rv32i::rs1(branch) | rv32i::rs2(branch);
+        if (reg == 0 || (rv32i::rs1(branch) && rv32i::rs2(branch))) return false;
+
+        uint32_t addi = backdoor_.fetch(pc - 4);
+        if (rv32i::opcode(addi) != rv32i::OP_IMM || rv32i::funct3(addi) != 0 || rv32i::rd(addi) != reg ||
+            rv32i::rs1(addi) != reg || rv32i::immI(addi) >= 0)
+            return false;
+        step = uint32_t(-rv32i::immI(addi));
+        return true;
+    }
+
+    CpuBackdoor backdoor_;
+    bool seen_ = false;
+    uint32_t last_pc_ = 0;
+    uint32_t last_value_ = 0;
+    uint64_t last_cycle_ = 0;
+    uint64_t loops_ = 0;
+    uint64_t skipped_ = 0;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Host time per harness phase for the profiling build (PROFILE=1 ./profile.sh,
+// or -DRISKV_PROFILE=ON). PROFILE_PHASE("name") times the rest of the
+// enclosing block; blocks with the same name add up. Without PROFILE the
+// macro is empty and reportPhases() prints nothing.
+//
+// Each timed block costs two steady_clock reads (a few tens of ns), so time
+// per-cycle blocks only where the split is worth that.
+
+#ifdef PROFILE
+
+struct PhaseTotal
+{
+    double seconds = 0;
+    uint64_t calls = 0;
+};
+
+inline std::map<std::string, PhaseTotal> &phaseTotals()
+{
+    static std::map<std::string, PhaseTotal> totals;
+    return totals;
+}
+
+inline std::chrono::steady_clock::time_point phaseStart()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return start;
+}
+
+class PhaseScope
+{
+public:
+    explicit PhaseScope(PhaseTotal &total) : total_(total), start_(std::chrono::steady_clock::now()) {}
+    ~PhaseScope()
+    {
+        total_.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        total_.calls++;
+    }
+
+private:
+    PhaseTotal &total_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// one map lookup per call site, the first time it runs
+inline PhaseTotal &phaseTotal(const char* name)
+{
+    phaseStart();
+    return phaseTotals()[name];
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_PHASE(name)                                                                  \
+    static PhaseTotal &PROFILE_CONCAT(phase_total_, __LINE__) = phaseTotal(name);            \
+    PhaseScope PROFILE_CONCAT(phase_scope_, __LINE__)(PROFILE_CONCAT(phase_total_, __LINE__))
+
+// Phases sorted by time, plus whatever wasn't inside any of them (gtest,
+// untimed harness code) since the first phase started
+inline void reportPhases(std::ostream &out)
+{
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - phaseStart()).count();
+    std::vector<std::pair<std::string, PhaseTotal>> phases(phaseTotals().begin(), phaseTotals().end());
+    std::sort(phases.begin(), phases.end(), [](auto &a, auto &b) { return a.second.seconds > b.second.seconds; });
+
+    double timed = 0;
+    for (const auto &phase : phases) timed += phase.second.seconds;
+    phases.push_back({"(untimed)", {std::max(0.0, wall - timed), 0}});
+
+    out << "harness phases, " << std::fixed << std::setprecision(3) << wall << " s wall:\n";
+    out << std::left << std::setw(16) << "  phase" << std::right << std::setw(12) << "seconds" << std::setw(9) << "%"
+        << std::setw(14) << "calls" << std::setw(12) << "ns/call" << "\n";
+    for (const auto &phase : phases)
+    {
+        const PhaseTotal &total = phase.second;
+        out << "  " << std::left << std::setw(14) << phase.first << std::right << std::setw(12)
+            << std::setprecision(3) << total.seconds << std::setw(8) << std::setprecision(1)
+            << (wall > 0 ? 100 * total.seconds / wall : 0) << "%" << std::setw(14) << total.calls << std::setw(12)
+            << std::setprecision(0) << (total.calls ? 1e9 * total.seconds / total.calls : 0) << "\n";
+    }
+}
+
+#else
+
+#define PROFILE_PHASE(name)
+
+inline void reportPhases(std::ostream &) {}
+
+#endif
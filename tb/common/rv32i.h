@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// RV32I encoders, field accessors and a small disassembler shared by the
+// program generator, the reference model, the fuzz reports and the loop
+// skipper.
+namespace rv32i
+{
+
+enum Opcode : uint32_t
+{
+    OP_LOAD   = 0x03,
+    OP_IMM    = 0x13,
+    OP_AUIPC  = 0x17,
+    OP_STORE  = 0x23,
+    OP_REG    = 0x33,
+    OP_LUI    = 0x37,
+    OP_BRANCH = 0x63,
+    OP_JALR   = 0x67,
+    OP_JAL    = 0x6F
+};
+
+constexpr uint32_t RESET_VECTOR = 0xBFC00000;
+constexpr uint32_t NOP = 0x00000013; // addi x0, x0, 0
+
+inline uint32_t opcode(uint32_t insn) { return insn & 0x7F; }
+inline uint32_t rd(uint32_t insn) { return (insn >> 7) & 0x1F; }
+inline uint32_t funct3(uint32_t insn) { return (insn >> 12) & 0x7; }
+inline uint32_t rs1(uint32_t insn) { return (insn >> 15) & 0x1F; }
+inline uint32_t rs2(uint32_t insn) { return (insn >> 20) & 0x1F; }
+inline uint32_t funct7(uint32_t insn) { return insn >> 25; }
+
+inline int32_t immI(uint32_t insn) { return int32_t(insn) >> 20; }
+inline int32_t immS(uint32_t insn) { return (int32_t(insn & 0xFE000000) >> 20) | ((insn >> 7) & 0x1F); }
+inline int32_t immB(uint32_t insn)
+{
+    return (int32_t(insn & 0x80000000) >> 19) | ((insn & 0x80) << 4) | ((insn >> 20) & 0x7E0) | ((insn >> 7) & 0x1E);
+}
+inline int32_t immU(uint32_t insn) { return int32_t(insn & 0xFFFFF000); }
+inline int32_t immJ(uint32_t insn)
+{
+    return (int32_t(insn & 0x80000000) >> 11) | (insn & 0xFF000) | ((insn >> 9) & 0x800) | ((insn >> 20) & 0x7FE);
+}
+
+inline uint32_t encR(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, uint32_t rs2, uint32_t f7)
+{
+    return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+inline uint32_t encI(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, int32_t imm)
+{
+    return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+inline uint32_t encS(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | ((imm & 0x1F) << 7) | OP_STORE;
+}
+inline uint32_t encB(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    return (uint32_t((imm >> 12) & 1) << 31) | (uint32_t((imm >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) |
+           (f3 << 12) | (uint32_t((imm >> 1) & 0xF) << 8) | (uint32_t((imm >> 11) & 1) << 7) | OP_BRANCH;
+}
+inline uint32_t encU(uint32_t op, uint32_t rd, uint32_t imm20) { return (imm20 << 12) | (rd << 7) | op; }
+inline uint32_t encJ(uint32_t rd, int32_t imm)
+{
+    return (uint32_t((imm >> 20) & 1) << 31) | (uint32_t((imm >> 1) & 0x3FF) << 21) | (uint32_t((imm >> 11) & 1) << 20) |
+           (uint32_t((imm >> 12) & 0xFF) << 12) | (rd << 7) | OP_JAL;
+}
+
+inline std::string reg(uint32_t r) { return "x" + std::to_string(r); }
+
+inline std::string disasm(uint32_t insn)
+{
+    static const char* const alu[8] = {"add", "sll", "slt", "sltu", "xor", "srl", "or", "and"};
+    static const char* const branch[8] = {"beq", "bne", "b?2", "b?3", "blt", "bge", "bltu", "bgeu"};
+    static const char* const load[8] = {"lb", "lh", "lw", "l?3", "lbu", "lhu", "l?6", "l?7"};
+    static const char* const store[8] = {"sb", "sh", "sw", "s?3", "s?4", "s?5", "s?6", "s?7"};
+
+    char buf[64];
+    uint32_t f3 = funct3(insn);
+    switch (opcode(insn))
+    {
+    case OP_REG:
+    {
+        std::string name = alu[f3];
+        if (f3 == 0 && (insn >> 30) & 1) name = "sub";
+        if (f3 == 5 && (insn >> 30) & 1) name = "sra";
+        snprintf(buf, sizeof(buf), "%-6s %s, %s, %s", name.c_str(), reg(rd(insn)).c_str(), reg(rs1(insn)).c_str(),
+                 reg(rs2(insn)).c_str());
+        break;
+    }
+    case OP_IMM:
+    {
+        std::string name = f3 == 3 ? "sltiu" : std::string(alu[f3]) + "i";
+        int32_t imm = immI(insn);
+        if (f3 == 1 || f3 == 5)
+        {
+            if (f3 == 5 && (insn >> 30) & 1) name = "srai";
+            imm &= 0x1F;
+        }
+        snprintf(buf, sizeof(buf), "%-6s %s, %s, %d", name.c_str(), reg(rd(insn)).c_str(), reg(rs1(insn)).c_str(), imm);
+        break;
+    }
+    case OP_LOAD:
+        snprintf(buf, sizeof(buf), "%-6s %s, %d(%s)", load[f3], reg(rd(insn)).c_str(), immI(insn), reg(rs1(insn)).c_str());
+        break;
+    case OP_STORE:
+        snprintf(buf, sizeof(buf), "%-6s %s, %d(%s)", store[f3], reg(rs2(insn)).c_str(), immS(insn), reg(rs1(insn)).c_str());
+        break;
+    case OP_BRANCH:
+        snprintf(buf, sizeof(buf), "%-6s %s, %s, %+d", branch[f3], reg(rs1(insn)).c_str(), reg(rs2(insn)).c_str(), immB(insn));
+        break;
+    case OP_LUI:
+        snprintf(buf, sizeof(buf), "%-6s %s, 0x%x", "lui", reg(rd(insn)).c_str(), insn >> 12);
+        break;
+    case OP_AUIPC:
+        snprintf(buf, sizeof(buf), "%-6s %s, 0x%x", "auipc", reg(rd(insn)).c_str(), insn >> 12);
+        break;
+    case OP_JAL:
+        snprintf(buf, sizeof(buf), "%-6s %s, %+d", "jal", reg(rd(insn)).c_str(), immJ(insn));
+        break;
+    case OP_JALR:
+        snprintf(buf, sizeof(buf), "%-6s %s, %d(%s)", "jalr", reg(rd(insn)).c_str(), immI(insn), reg(rs1(insn)).c_str());
+        break;
+    default:
+        snprintf(buf, sizeof(buf), ".word  0x%08x", insn);
+        break;
+    }
+    return buf;
+}
+
+} // namespace rv32i
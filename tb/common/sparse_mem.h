@@ -0,0 +1,261 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sparse, page-allocated model of the full 32-bit data address space.
+// Pages are only allocated on first write, so multi-megabyte datasets cost
+// what they touch rather than a dense array. Used as the data_mem_sparse
+// backend through the DPI functions at the bottom of this file, and directly
+// by harnesses for backdoor loads/dumps.
+class SparseMem
+{
+public:
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+    static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+
+    struct PageStats
+    {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+    };
+
+    uint8_t read8(uint32_t addr) const
+    {
+        const Page* page = findPage(addr >> PAGE_BITS);
+        return page ? page->data[addr & PAGE_MASK] : 0;
+    }
+
+    void write8(uint32_t addr, uint8_t value)
+    {
+        getPage(addr >> PAGE_BITS)->data[addr & PAGE_MASK] = value;
+    }
+
+    // little endian word access, counted in the page statistics
+    uint32_t read32(uint32_t addr)
+    {
+        countRead(addr);
+        return peek32(addr);
+    }
+
+    // the same without counting, for combinational reads that are evaluated
+    // more often than the memory is accessed
+    uint32_t peek32(uint32_t addr) const
+    {
+        const Page* page = findPage(addr >> PAGE_BITS);
+        if (page && (addr & PAGE_MASK) <= PAGE_SIZE - 4)
+        {
+            const uint8_t* p = &page->data[addr & PAGE_MASK];
+            return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+        }
+        // unaligned access crossing a page boundary, or an unmapped page
+        return read8(addr) | (read8(addr + 1) << 8) | (read8(addr + 2) << 16) | (uint32_t(read8(addr + 3)) << 24);
+    }
+
+    void countRead(uint32_t addr)
+    {
+        Page* page = findPage(addr >> PAGE_BITS);
+        if (page) page->stats.reads++;
+        else unmapped_reads_++;
+    }
+
+    void write32(uint32_t addr, uint32_t value)
+    {
+        Page* page = getPage(addr >> PAGE_BITS);
+        page->stats.writes++;
+        if ((addr & PAGE_MASK) <= PAGE_SIZE - 4)
+        {
+            uint8_t* p = &page->data[addr & PAGE_MASK];
+            p[0] = value;
+            p[1] = value >> 8;
+            p[2] = value >> 16;
+            p[3] = value >> 24;
+            return;
+        }
+        for (int i = 0; i < 4; i++)
+            write8(addr + i, value >> (8 * i));
+    }
+
+    // Loads a $readmemh style byte file (one hex byte per token, optional
+    // @<hex> byte address directives, // comments) starting at base.
+    // Returns the number of bytes loaded, or -1 if the file can't be opened.
+    long loadHex(const std::string &path, uint32_t base)
+    {
+        std::ifstream file(path);
+        if (!file) return -1;
+
+        long count = 0;
+        uint32_t addr = base;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = line.substr(0, line.find("//"));
+            std::istringstream tokens(line);
+            std::string token;
+            while (tokens >> token)
+            {
+                if (token[0] == '@')
+                {
+                    addr = std::stoul(token.substr(1), nullptr, 16);
+                    continue;
+                }
+                write8(addr++, std::stoul(token, nullptr, 16));
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Loads a raw binary image starting at base
+    long loadBin(const std::string &path, uint32_t base)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return -1;
+
+        std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        loadBytes(base, reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
+        return buffer.size();
+    }
+
+    void loadBytes(uint32_t base, const uint8_t* bytes, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+            write8(base + i, bytes[i]);
+    }
+
+    // Dumps [base, base + len) in the same format loadHex reads, 16 bytes per line
+    bool dumpHex(const std::string &path, uint32_t base, uint32_t len) const
+    {
+        std::ofstream file(path);
+        if (!file) return false;
+
+        file << std::hex << std::uppercase << std::setfill('0');
+        for (uint32_t i = 0; i < len; i++)
+        {
+            file << std::setw(2) << int(read8(base + i));
+            file << (((i & 15) == 15 || i + 1 == len) ? '\n' : ' ');
+        }
+        return true;
+    }
+
+    bool dumpBin(const std::string &path, uint32_t base, uint32_t len) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        for (uint32_t i = 0; i < len; i++)
+            file.put(read8(base + i));
+        return true;
+    }
+
+    void clear()
+    {
+        pages_.clear();
+        unmapped_reads_ = 0;
+        last_index_ = 0;
+        last_page_ = nullptr;
+    }
+
+    size_t pageCount() const { return pages_.size(); }
+    uint64_t unmappedReads() const { return unmapped_reads_; }
+
+    // per-page access counts, keyed by page base address
+    std::map<uint32_t, PageStats> pageStats() const
+    {
+        std::map<uint32_t, PageStats> stats;
+        for (const auto &entry : pages_)
+            stats[entry.first << PAGE_BITS] = entry.second->stats;
+        return stats;
+    }
+
+    void printStats(std::ostream &os) const
+    {
+        os << "sparse_mem: " << pageCount() << " pages (" << (pageCount() * PAGE_SIZE / 1024) << " KB) allocated, "
+           << unmapped_reads_ << " unmapped reads" << std::endl;
+        for (const auto &entry : pageStats())
+        {
+            os << "  page 0x" << std::hex << std::setw(8) << std::setfill('0') << entry.first << std::dec
+               << std::setfill(' ') << "  reads " << std::setw(10) << entry.second.reads
+               << "  writes " << std::setw(10) << entry.second.writes << std::endl;
+        }
+    }
+
+private:
+    struct Page
+    {
+        std::array<uint8_t, PAGE_SIZE> data{};
+        PageStats stats;
+    };
+
+    Page* findPage(uint32_t index) const
+    {
+        // the core tends to hammer one page at a time, so cache the last hit
+        if (last_page_ && last_index_ == index) return last_page_;
+        auto it = pages_.find(index);
+        if (it == pages_.end()) return nullptr;
+        last_index_ = index;
+        last_page_ = it->second.get();
+        return last_page_;
+    }
+
+    Page* getPage(uint32_t index)
+    {
+        Page* page = findPage(index);
+        if (page) return page;
+        auto &slot = pages_[index];
+        slot = std::make_unique<Page>();
+        last_index_ = index;
+        last_page_ = slot.get();
+        return last_page_;
+    }
+
+    std::unordered_map<uint32_t, std::unique_ptr<Page>> pages_;
+    uint64_t unmapped_reads_ = 0;
+    mutable uint32_t last_index_ = 0;
+    mutable Page* last_page_ = nullptr;
+};
+
+// Single instance shared by data_mem_sparse and the harness
+inline SparseMem &sparseMem()
+{
+    static SparseMem mem;
+    return mem;
+}
+
+// DPI imports used by rtl/data_mem_sparse.sv. Only defined in builds that
+// verilate data_mem_sparse (SPARSE_MEM=1 ./doit.sh, or its unit test).
+#ifdef SPARSE_MEM
+extern "C" unsigned int sparse_mem_read(unsigned int addr, unsigned int /*gen*/)
+{
+    return sparseMem().peek32(addr);
+}
+
+extern "C" void sparse_mem_count_read(unsigned int addr)
+{
+    sparseMem().countRead(addr);
+}
+
+extern "C" void sparse_mem_write(unsigned int addr, unsigned int data)
+{
+    sparseMem().write32(addr, data);
+}
+
+extern "C" int sparse_mem_load_hex(const char* path, unsigned int base)
+{
+    long count = sparseMem().loadHex(path, base);
+    if (count < 0)
+        std::cerr << "%Warning: " << path << ":0: sparse_mem file not found" << std::endl;
+    return count < 0 ? -1 : 0;
+}
+#endif
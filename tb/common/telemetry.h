@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "cpu_backdoor.h"
+
+// Periodic progress report for long simulations: every interval cycles it
+// prints simulated cycles per second, retired instructions, IPC, the PC and
+// the label it falls under, and data memory traffic to stderr, and rewrites a
+// Prometheus text-format file that a node_exporter textfile collector or any
+// local dashboard can scrape.
+//
+// Cycles are the core's mcycle, like the instructions are its minstret, so
+// both cover the same interval: from reset release to the halt, without the
+// cycles the harness spends in reset or clocking past the halt.
+//
+// sample() is called every cycle but only compares the cycle count with the
+// next report, the clock is read and files written once per interval.
+class Telemetry
+{
+public:
+    Telemetry(Vdut* top, const std::string &name, uint64_t interval, const std::string &metrics_path = "")
+        : backdoor_(top), name_(name), interval_(interval), next_(interval), metrics_path_(metrics_path),
+          start_(std::chrono::steady_clock::now()), last_time_(start_)
+    {
+    }
+
+    // Labels from an objdump disassembly (program.dis), so reports name the
+    // routine the PC is in
+    void loadSymbols(const std::string &dis_path)
+    {
+        std::ifstream file(dis_path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            // bfc00000 <main>:
+            size_t open = line.find(" <");
+            if (open == std::string::npos || line.size() < 3 || line.compare(line.size() - 2, 2, ">:") != 0)
+                continue;
+            symbols_[std::stoul(line.substr(0, open), nullptr, 16)] = line.substr(open + 2, line.size() - open - 4);
+        }
+    }
+
+    void sample()
+    {
+        uint64_t cycle = backdoor_.cycles();
+        if (cycle < next_) return;
+        report(cycle);
+        next_ = (cycle / interval_ + 1) * interval_;
+    }
+
+    void report(uint64_t cycle)
+    {
+        auto now = std::chrono::steady_clock::now();
+        double interval_seconds = std::chrono::duration<double>(now - last_time_).count();
+        double total_seconds = std::chrono::duration<double>(now - start_).count();
+        uint64_t instret = backdoor_.instret();
+        double rate = interval_seconds > 0 ? (cycle - last_cycle_) / interval_seconds : 0;
+        double ipc = cycle > last_cycle_ ? double(instret - last_instret_) / (cycle - last_cycle_) : 0;
+        uint32_t pc = backdoor_.pc();
+        std::string region = regionOf(pc);
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << "[telemetry] " << name_ << " cycle " << cycle << " | "
+             << rate / 1e6 << " Mcycles/s | instret " << instret << " | IPC " << ipc << " | pc " << std::hex
+             << std::setw(8) << std::setfill('0') << pc << std::dec;
+        if (!region.empty()) line << " (" << region << ")";
+        line << " | loads " << backdoor_.loads() << " stores " << backdoor_.stores() << "\n";
+        std::cerr << line.str();
+
+        if (!metrics_path_.empty()) writeMetrics(cycle, instret, rate, ipc, pc, region, total_seconds);
+
+        last_time_ = now;
+        last_cycle_ = cycle;
+        last_instret_ = instret;
+    }
+
+private:
+    std::string regionOf(uint32_t pc) const
+    {
+        auto it = symbols_.upper_bound(pc);
+        return it == symbols_.begin() ? "" : std::prev(it)->second;
+    }
+
+    // written to a temporary file and renamed, so a scrape never sees half of it
+    void writeMetrics(uint64_t cycle, uint64_t instret, double rate, double ipc, uint32_t pc,
+                      const std::string &region, double seconds) const
+    {
+        std::string labels = "{test=\"" + name_ + "\"}";
+        std::string tmp = metrics_path_ + ".tmp";
+        {
+            std::ofstream file(tmp);
+            auto metric = [&](const char* metric, const char* type, const char* help, auto value,
+                              const std::string &extra = "") {
+                file << "# HELP " << metric << " " << help << "\n# TYPE " << metric << " " << type << "\n"
+                     << metric << (extra.empty() ? labels : extra) << " " << value << "\n";
+            };
+            file << std::fixed << std::setprecision(3);
+            metric("riskv_sim_cycles_total", "counter", "Simulated clock cycles", cycle);
+            metric("riskv_sim_cycles_per_second", "gauge", "Simulated cycles per host second, last interval", rate);
+            metric("riskv_sim_seconds_total", "counter", "Host seconds since the run started", seconds);
+            metric("riskv_instret_total", "counter", "Retired instructions", instret);
+            metric("riskv_ipc", "gauge", "Instructions per cycle, last interval", ipc);
+            metric("riskv_pc", "gauge", "Fetch PC at the last sample", pc,
+                   "{test=\"" + name_ + "\",region=\"" + region + "\"}");
+            metric("riskv_mem_loads_total", "counter", "Data memory loads", backdoor_.loads());
+            metric("riskv_mem_stores_total", "counter", "Data memory stores", backdoor_.stores());
+            metric("riskv_bp_lookups_total", "counter", "Branches and jumps resolved", backdoor_.bpLookups());
+            metric("riskv_bp_hits_total", "counter", "Branches and jumps the predictor had a target for", backdoor_.bpHits());
+            metric("riskv_bp_mispredicts_total", "counter", "Fetch redirects from execute", backdoor_.bpMispredicts());
+            metric("riskv_icache_hits_total", "counter", "Instructions fetched from the instruction cache", backdoor_.icacheHits());
+            metric("riskv_icache_misses_total", "counter", "Instruction cache refills", backdoor_.icacheMisses());
+            metric("riskv_icache_stall_cycles_total", "counter", "Cycles fetch waited on a refill", backdoor_.icacheStalls());
+            metric("riskv_dcache_accesses_total", "counter", "Loads and stores the data cache completed", backdoor_.dcacheAccesses());
+            metric("riskv_dcache_misses_total", "counter", "Data cache misses", backdoor_.dcacheMisses());
+            metric("riskv_dcache_writebacks_total", "counter", "Dirty lines written back", backdoor_.dcacheWritebacks());
+            metric("riskv_dcache_stall_cycles_total", "counter", "Cycles the core held for the data cache", backdoor_.dcacheStalls());
+            metric("riskv_dcache_victim_hits_total", "counter", "Data cache misses the victim cache saved", backdoor_.dcacheVictimHits());
+            metric("riskv_dcache_deferred_total", "counter", "Load misses the core went on past", backdoor_.dcacheDeferred());
+            metric("riskv_dcache_pending_stall_cycles_total", "counter", "Cycles decode waited for a deferred load", backdoor_.dcachePendingStalls());
+            metric("riskv_prefetches_total", "counter", "Lines the data prefetcher filled", backdoor_.prefetches());
+            metric("riskv_prefetches_useful_total", "counter", "Prefetched lines a load or store hit", backdoor_.prefetchesUseful());
+            metric("riskv_store_buffer_forwards_total", "counter", "Loads answered from the store buffer", backdoor_.storeBufferForwards());
+            metric("riskv_store_buffer_stall_cycles_total", "counter", "Cycles the core held for the store buffer", backdoor_.storeBufferStalls());
+        }
+        std::rename(tmp.c_str(), metrics_path_.c_str());
+    }
+
+    CpuBackdoor backdoor_;
+    std::string name_;
+    uint64_t interval_;
+    uint64_t next_;
+    std::string metrics_path_;
+    std::map<uint32_t, std::string> symbols_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point last_time_;
+    uint64_t last_cycle_ = 0;
+    uint64_t last_instret_ = 0;
+};
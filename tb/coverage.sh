@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# Merges the coverage databases written by a coverage build and reports the holes
+# Usage: COVERAGE=1 ./doit.sh <tests>; COVERAGE=1 ./fuzz.sh; ./coverage.sh [--toggles] [--limit N] [paths]
+# Without paths every .dat under test_out/ is merged into test_out/coverage.dat
+
+# Constants
+SCRIPT_DIR=$(dirname "$(realpath "$0")")
+BUILD_DIR="$SCRIPT_DIR/obj_coverage"
+RED=$(tput setaf 1)
+RESET=$(tput sgr0)
+
+cd "$SCRIPT_DIR" || exit
+
+mkdir -p "$BUILD_DIR"
+if [[ ! -x "$BUILD_DIR/covmerge" || coverage/covmerge.cpp -nt "$BUILD_DIR/covmerge" || coverage/covmerge.h -nt "$BUILD_DIR/covmerge" ]]; then
+    if ! g++ -std=c++17 -O2 -pthread -o "$BUILD_DIR/covmerge" coverage/covmerge.cpp; then
+        echo "${RED}Error: failed to build covmerge${RESET}"
+        exit 1
+    fi
+fi
+
+# paths are whatever doesn't start with a dash
+paths=0
+for arg in "$@"; do
+    [[ "$arg" != -* ]] && ((paths++))
+done
+if [[ $paths -eq 0 ]]; then
+    set -- "$@" test_out
+fi
+
+"$BUILD_DIR/covmerge" -o test_out/coverage.dat "$@"
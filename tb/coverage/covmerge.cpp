@@ -0,0 +1,169 @@
+// Merges Verilator coverage databases from any number of runs and reports the
+// holes: line, branch, expression and user cover points that were never hit,
+// and toggle holes summarized per module.
+//
+// Usage: covmerge [-o merged.dat] [-j threads] [--toggles] [--limit N] <file.dat|dir>...
+//   Directories are searched recursively for *.dat files. Exits with 1 if no
+//   database could be read.
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "covmerge.h"
+
+struct Options
+{
+    std::vector<std::string> inputs;
+    std::string out;
+    unsigned jobs = std::thread::hardware_concurrency();
+    bool toggles = false;
+    size_t limit = 200;
+};
+
+static Options parseArgs(int argc, char** argv)
+{
+    Options opts;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "missing value for " << arg << std::endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "-o") opts.out = next();
+        else if (arg == "-j") opts.jobs = std::stoul(next());
+        else if (arg == "--toggles") opts.toggles = true;
+        else if (arg == "--limit") opts.limit = std::stoul(next());
+        else if (arg[0] == '-')
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            exit(2);
+        }
+        else opts.inputs.push_back(arg);
+    }
+    return opts;
+}
+
+// skip is the merged output, so re-running over the same folder doesn't count it twice
+static std::vector<std::string> collectFiles(const std::vector<std::string> &inputs, const std::string &skip)
+{
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::path skip_path = skip.empty() ? fs::path() : fs::weakly_canonical(skip, error);
+    std::vector<std::string> files;
+    for (const std::string &input : inputs)
+    {
+        if (!fs::is_directory(input))
+        {
+            files.push_back(input);
+            continue;
+        }
+        for (const auto &entry : fs::recursive_directory_iterator(input))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".dat" &&
+                fs::weakly_canonical(entry.path(), error) != skip_path)
+                files.push_back(entry.path().string());
+        }
+    }
+    return files;
+}
+
+// module name from a hierarchy such as TOP.top.decode.regfile
+static std::string moduleOf(const CoverageDb::Point &point)
+{
+    size_t dot = point.hier.rfind('.');
+    return dot == std::string::npos ? point.hier : point.hier.substr(dot + 1);
+}
+
+int main(int argc, char** argv)
+{
+    Options opts = parseArgs(argc, argv);
+    std::vector<std::string> files = collectFiles(opts.inputs, opts.out);
+    if (files.empty())
+    {
+        std::cerr << "covmerge: no coverage databases given" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> failed;
+    CoverageDb db = CoverageDb::mergeFiles(files, opts.jobs, &failed);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const std::string &file : failed) std::cerr << "covmerge: skipped unreadable " << file << std::endl;
+    if (failed.size() == files.size()) return 1;
+
+    std::cout << "covmerge: " << files.size() - failed.size() << " databases, " << db.size() << " points merged in "
+              << std::fixed << std::setprecision(2) << elapsed << " s" << std::endl;
+
+    if (!opts.out.empty() && !db.write(opts.out))
+    {
+        std::cerr << "covmerge: could not write " << opts.out << std::endl;
+        return 1;
+    }
+
+    // per type totals, holes listed in file/line order
+    struct Totals
+    {
+        size_t points = 0;
+        size_t hit = 0;
+    };
+    std::map<std::string, Totals> totals;
+    std::map<std::string, std::vector<CoverageDb::Point>> holes;
+    std::map<std::string, size_t> toggle_holes;
+    for (const CoverageDb::Point &point : db.points())
+    {
+        Totals &total = totals[point.type];
+        total.points++;
+        if (point.count >= point.thresh)
+        {
+            total.hit++;
+            continue;
+        }
+        if (point.type == "toggle") toggle_holes[moduleOf(point)]++;
+        if (point.type != "toggle" || opts.toggles) holes[point.type].push_back(point);
+    }
+
+    std::cout << "\ncoverage summary:" << std::endl;
+    for (const auto &entry : totals)
+    {
+        std::cout << "  " << std::left << std::setw(8) << entry.first << std::right << std::setw(7) << entry.second.hit
+                  << " / " << std::setw(7) << entry.second.points << "  (" << std::setprecision(1)
+                  << 100.0 * entry.second.hit / entry.second.points << "%)" << std::endl;
+    }
+
+    for (const auto &entry : holes)
+    {
+        std::cout << "\n" << entry.first << " holes (" << entry.second.size() << "):" << std::endl;
+        size_t shown = 0;
+        for (const CoverageDb::Point &point : entry.second)
+        {
+            if (shown++ == opts.limit)
+            {
+                std::cout << "  ... " << entry.second.size() - opts.limit << " more, raise --limit" << std::endl;
+                break;
+            }
+            std::cout << "  " << point.file << ":" << point.line << "  " << point.hier;
+            if (!point.comment.empty()) std::cout << "  " << point.comment;
+            if (point.thresh > 1) std::cout << "  (" << point.count << "/" << point.thresh << ")";
+            std::cout << std::endl;
+        }
+    }
+
+    if (!toggle_holes.empty() && !opts.toggles)
+    {
+        std::cout << "\ntoggle holes by module (--toggles to list them):" << std::endl;
+        for (const auto &entry : toggle_holes) std::cout << "  " << entry.first << ": " << entry.second << std::endl;
+    }
+    return 0;
+}
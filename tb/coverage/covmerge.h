@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Reader, merger and writer for Verilator coverage databases (coverage.dat).
+//
+// Each point is a line `C '<keys>' <count>` where <keys> is a list of
+// \001key\002value pairs (type, file, line, hierarchy, comment, ...). Points
+// with identical keys are the same point in different runs, so merging is a
+// sum of counts keyed on the raw key string. Keys are never decoded on the
+// merge path; only the report splits them into fields.
+//
+// Databases written by the same model list their points in the same order,
+// so the reader remembers which entry the n-th line hit last time and only
+// falls back to hashing when the key at that position differs.
+class CoverageDb
+{
+public:
+    struct Point
+    {
+        std::string type;    // line, toggle, branch, expr, user, ...
+        std::string file;
+        unsigned line = 0;
+        std::string hier;
+        std::string comment;
+        uint64_t count = 0;
+        uint64_t thresh = 1; // a point is a hole while count < thresh
+    };
+
+    // Adds the points of one database. Returns false if the file can't be
+    // read or isn't a coverage database.
+    bool addFile(const std::string &path)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+        std::string text;
+        char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), file)) > 0) text.append(buf, n);
+        fclose(file);
+        return addText(text);
+    }
+
+    bool addText(const std::string &text)
+    {
+        if (text.compare(0, 10, "# SystemC:") != 0) return false;
+        const char* p = text.data();
+        const char* end = p + text.size();
+        size_t index = 0;
+        while (p < end)
+        {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (!eol) eol = end;
+            // C '<keys>' <count>
+            if (eol - p > 4 && p[0] == 'C' && p[1] == ' ' && p[2] == '\'')
+            {
+                const char* quote = eol - 1;
+                while (quote > p + 2 && *quote != '\'') quote--;
+                if (quote > p + 2)
+                {
+                    size_t length = quote - (p + 3);
+                    uint64_t count = strtoull(quote + 1, nullptr, 10);
+                    if (index < order_.size() && order_[index]->first.size() == length &&
+                        memcmp(order_[index]->first.data(), p + 3, length) == 0)
+                    {
+                        order_[index]->second += count;
+                    }
+                    else
+                    {
+                        auto entry = &*counts_.try_emplace(std::string(p + 3, length), 0).first;
+                        entry->second += count;
+                        if (index < order_.size()) order_[index] = entry;
+                        else order_.push_back(entry);
+                    }
+                    index++;
+                }
+            }
+            p = eol + 1;
+        }
+        return true;
+    }
+
+    void merge(const CoverageDb &other)
+    {
+        for (const auto &entry : other.counts_) counts_[entry.first] += entry.second;
+    }
+
+    size_t size() const { return counts_.size(); }
+
+    // Count of the point with exactly these raw keys, 0 if it was never seen
+    uint64_t count(const std::string &keys) const
+    {
+        auto it = counts_.find(keys);
+        return it == counts_.end() ? 0 : it->second;
+    }
+
+    // Writes a database verilator_coverage can read, points sorted by key so
+    // merges of the same runs are byte identical
+    bool write(const std::string &path) const
+    {
+        std::vector<const std::pair<const std::string, uint64_t>*> sorted;
+        sorted.reserve(counts_.size());
+        for (const auto &entry : counts_) sorted.push_back(&entry);
+        std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->first < b->first; });
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+        file << "# SystemC::Coverage-3\n";
+        for (auto entry : sorted) file << "C '" << entry->first << "' " << entry->second << "\n";
+        return bool(file);
+    }
+
+    std::vector<Point> points() const
+    {
+        std::vector<Point> result;
+        result.reserve(counts_.size());
+        for (const auto &entry : counts_) result.push_back(decode(entry.first, entry.second));
+        std::sort(result.begin(), result.end(), [](const Point &a, const Point &b) {
+            if (a.file != b.file) return a.file < b.file;
+            if (a.line != b.line) return a.line < b.line;
+            if (a.hier != b.hier) return a.hier < b.hier;
+            return a.comment < b.comment;
+        });
+        return result;
+    }
+
+    static Point decode(const std::string &keys, uint64_t count)
+    {
+        Point point;
+        point.count = count;
+        std::string page;
+        size_t pos = 0;
+        while ((pos = keys.find('\001', pos)) != std::string::npos)
+        {
+            size_t sep = keys.find('\002', pos);
+            if (sep == std::string::npos) break;
+            size_t next = keys.find('\001', sep);
+            std::string key = keys.substr(pos + 1, sep - pos - 1);
+            std::string value = keys.substr(sep + 1, (next == std::string::npos ? keys.size() : next) - sep - 1);
+            if (key == "t") point.type = value;
+            else if (key == "page") page = value;
+            else if (key == "f") point.file = value;
+            else if (key == "l") point.line = std::stoul(value);
+            else if (key == "h") point.hier = value;
+            else if (key == "o") point.comment = value;
+            else if (key == "s") point.thresh = std::stoull(value);
+            pos = sep;
+        }
+        // the page (v_line/<module>, v_toggle/<module>, v_user/<module>, ...)
+        // names the kind of point, user cover points have nothing else
+        if (page.compare(0, 2, "v_") == 0) point.type = page.substr(2, page.find('/') - 2);
+        if (point.type.empty()) point.type = "user";
+        return point;
+    }
+
+    // Merges files on threads threads: each thread sums a share of the files
+    // into its own table, then the tables are folded together. Files that
+    // can't be read are appended to failed.
+    static CoverageDb mergeFiles(const std::vector<std::string> &files, unsigned threads,
+                                 std::vector<std::string>* failed = nullptr)
+    {
+        threads = std::max(1u, std::min<unsigned>(threads, files.size()));
+        std::vector<CoverageDb> partial(threads);
+        std::vector<std::vector<std::string>> bad(threads);
+        std::atomic<size_t> next{0};
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++)
+        {
+            pool.emplace_back([&, t]() {
+                for (size_t i; (i = next++) < files.size();)
+                {
+                    if (!partial[t].addFile(files[i])) bad[t].push_back(files[i]);
+                }
+            });
+        }
+        for (auto &thread : pool) thread.join();
+
+        // pairwise tree reduction, each level in parallel
+        for (size_t stride = 1; stride < threads; stride *= 2)
+        {
+            pool.clear();
+            for (size_t t = 0; t + stride < threads; t += 2 * stride)
+                pool.emplace_back([&, t, stride]() { partial[t].merge(partial[t + stride]); });
+            for (auto &thread : pool) thread.join();
+        }
+
+        if (failed)
+            for (const auto &list : bad) failed->insert(failed->end(), list.begin(), list.end());
+        return std::move(partial[0]);
+    }
+
+private:
+    std::unordered_map<std::string, uint64_t> counts_;
+    // entry hit by the n-th point of the last database read
+    std::vector<std::pair<const std::string, uint64_t>*> order_;
+};
@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "covmerge.h"
+
+// keys as Verilator writes them: \001key\002value pairs
+static std::string keys(const std::string &page, const std::string &file, int line, const std::string &comment)
+{
+    return "\001page\002" + page + "\001f\002" + file + "\001l\002" + std::to_string(line) + "\001o\002" + comment +
+           "\001h\002TOP.top\001";
+}
+
+static std::string database(const std::vector<std::pair<std::string, int>> &points)
+{
+    std::string text = "# SystemC::Coverage-3\n";
+    for (const auto &point : points) text += "C '" + point.first + "' " + std::to_string(point.second) + "\n";
+    return text;
+}
+
+class CovMergeTest : public ::testing::Test
+{
+protected:
+    std::string line_ = keys("v_line/top", "top.sv", 10, "block");
+    std::string user_ = keys("v_user/coverpoints", "coverpoints.sv", 31, "c_op");
+    std::string toggle_ = keys("v_toggle/top", "top.sv", 5, "a0[0]:0->1");
+};
+
+TEST_F(CovMergeTest, RejectsOtherFiles)
+{
+    CoverageDb db;
+    EXPECT_FALSE(db.addText("01 02 03 04\n"));
+    EXPECT_EQ(db.size(), 0);
+}
+
+TEST_F(CovMergeTest, SumsCountsOfSamePoint)
+{
+    CoverageDb db;
+    EXPECT_TRUE(db.addText(database({{line_, 3}, {user_, 0}})));
+    EXPECT_TRUE(db.addText(database({{line_, 4}, {toggle_, 1}})));
+
+    EXPECT_EQ(db.size(), 3);
+    EXPECT_EQ(db.count(line_), 7);
+    EXPECT_EQ(db.count(user_), 0);
+    EXPECT_EQ(db.count(toggle_), 1);
+}
+
+TEST_F(CovMergeTest, DecodesPointFields)
+{
+    CoverageDb::Point point = CoverageDb::decode(user_, 2);
+    EXPECT_EQ(point.type, "user");
+    EXPECT_EQ(point.file, "coverpoints.sv");
+    EXPECT_EQ(point.line, 31);
+    EXPECT_EQ(point.comment, "c_op");
+    EXPECT_EQ(point.hier, "TOP.top");
+    EXPECT_EQ(point.count, 2);
+
+    EXPECT_EQ(CoverageDb::decode(toggle_, 0).type, "toggle");
+    EXPECT_EQ(CoverageDb::decode(line_, 0).type, "line");
+}
+
+TEST_F(CovMergeTest, ParallelMergeMatchesSerial)
+{
+    // more files than threads, and counts that differ per file
+    std::vector<std::string> files;
+    CoverageDb serial;
+    for (int i = 0; i < 37; i++)
+    {
+        std::string text = database({{line_, i}, {user_, i % 3}, {toggle_, 1}});
+        std::string path = testing::TempDir() + "covmerge_" + std::to_string(i) + ".dat";
+        std::ofstream(path) << text;
+        files.push_back(path);
+        serial.addText(text);
+    }
+
+    std::vector<std::string> failed;
+    CoverageDb merged = CoverageDb::mergeFiles(files, 5, &failed);
+    EXPECT_TRUE(failed.empty());
+    EXPECT_EQ(merged.count(line_), serial.count(line_));
+    EXPECT_EQ(merged.count(user_), serial.count(user_));
+    EXPECT_EQ(merged.count(toggle_), 37);
+
+    for (const auto &path : files) std::remove(path.c_str());
+}
+
+TEST_F(CovMergeTest, WriteRoundTrips)
+{
+    CoverageDb db;
+    db.addText(database({{line_, 3}, {user_, 0}}));
+    std::string path = testing::TempDir() + "covmerge_out.dat";
+    ASSERT_TRUE(db.write(path));
+
+    CoverageDb reread;
+    EXPECT_TRUE(reread.addFile(path));
+    EXPECT_EQ(reread.size(), 2);
+    EXPECT_EQ(reread.count(line_), 3);
+    std::remove(path.c_str());
+}
+
+TEST_F(CovMergeTest, MissingFileIsReported)
+{
+    std::vector<std::string> failed;
+    CoverageDb::mergeFiles({testing::TempDir() + "covmerge_missing.dat"}, 4, &failed);
+    EXPECT_EQ(failed.size(), 1);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
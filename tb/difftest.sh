@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Builds and runs the combinational unit differential tester (difftest/difftest.cpp)
+# Usage: ./difftest.sh [--jobs N] [--vectors N] [--seconds T] [--seed S] [--unit NAME]
+
+# Constants
+SCRIPT_DIR=$(dirname "$(realpath "$0")")
+RTL_FOLDER=$(realpath "$SCRIPT_DIR/../rtl")
+BUILD_DIR="$SCRIPT_DIR/obj_difftest"
+UNITS=(ALU extend data_mem_i)
+GREEN=$(tput setaf 2)
+RED=$(tput setaf 1)
+RESET=$(tput sgr0)
+
+cd "$SCRIPT_DIR" || exit
+
+# -march=native lets the reference batches use the host's widest vectors
+CFLAGS="-std=c++17 -O3 -march=native -fopenmp-simd"
+VFLAGS=(-Wall -O3 --x-assign fast --x-initial fast -Wno-UNUSED)
+
+# Every unit gets its own prefix so the models link into one binary. The
+# first three become libraries, data_mem_o is built with the harness and
+# links them in.
+archives=()
+includes="-I$SCRIPT_DIR/difftest"
+for unit in "${UNITS[@]}"; do
+    verilator   "${VFLAGS[@]}" \
+                -cc "${RTL_FOLDER}/${unit}.sv" \
+                --prefix "V${unit}" \
+                --Mdir "$BUILD_DIR/$unit" \
+                -CFLAGS "$CFLAGS" \
+                > /dev/null
+    if ! make -j -C "$BUILD_DIR/$unit" -f "V${unit}.mk" > /dev/null; then
+        echo "${RED}Error: failed to build the ${unit} model${RESET}"
+        exit 1
+    fi
+    archives+=("$BUILD_DIR/$unit/V${unit}__ALL.a")
+    includes="$includes -I$BUILD_DIR/$unit"
+done
+
+verilator   "${VFLAGS[@]}" \
+            -cc "${RTL_FOLDER}/data_mem_o.sv" \
+            --exe "$SCRIPT_DIR/difftest/difftest.cpp" \
+            "${archives[@]}" \
+            --prefix "Vdata_mem_o" \
+            -o Vdifftest \
+            --Mdir "$BUILD_DIR/data_mem_o" \
+            -CFLAGS "$CFLAGS $includes" \
+            -LDFLAGS "-pthread" \
+            > /dev/null
+
+if ! make -j -C "$BUILD_DIR/data_mem_o" -f Vdata_mem_o.mk > /dev/null; then
+    echo "${RED}Error: failed to build the differential tester${RESET}"
+    exit 1
+fi
+
+"$BUILD_DIR/data_mem_o/Vdifftest" "$@"
+exit_code=$?
+
+if [ $exit_code -eq 0 ]; then
+    echo "${GREEN}Differential testing finished with no mismatches${RESET}"
+else
+    echo "${RED}Differential testing found mismatches${RESET}"
+fi
+exit $exit_code
@@ -0,0 +1,446 @@
+// Differential tester for the combinational units: drives ALU, extend,
+// data_mem_i and data_mem_o with random and corner-case vectors and compares
+// every output against the batched references in unit_ref.h.
+//
+// Built by difftest.sh (or the difftest CMake target) with each unit
+// verilated under its own prefix (VALU, Vextend, ...) so all four link into
+// one binary. One thread per core, each owning its own VerilatedContext and
+// models. Work is handed out in batches of BATCH vectors: a thread fills the
+// input arrays, runs the reference over the whole batch (SIMD), then
+// evaluates the model once per vector and compares. Control inputs step
+// through every code inside each batch, so every ALUCtrl_i x branch_i,
+// ImmSrc_i, mem_type_i x mem_sign_i x byte offset combination gets an equal
+// share of the vectors, undefined codes included.
+//
+// Usage: ./difftest.sh [--jobs N] [--vectors N] [--seconds T] [--seed S] [--unit NAME]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "VALU.h"
+#include "Vdata_mem_i.h"
+#include "Vdata_mem_o.h"
+#include "Vextend.h"
+#include "verilated.h"
+
+#include "unit_ref.h"
+
+// vectors per batch, big enough to amortize the reference call and the
+// atomic that hands out batches
+#define BATCH 4096
+// mismatches printed in total, the rest are only counted
+#define MAX_REPORTS 20
+
+struct Options
+{
+    unsigned jobs = std::thread::hardware_concurrency();
+    uint64_t vectors = 100000000; // per unit
+    double seconds = 0;
+    uint64_t seed = 1;
+    std::string unit;
+};
+
+// splitmix64, seeded per batch so any batch can be regenerated on its own
+class VectorSource
+{
+public:
+    explicit VectorSource(uint64_t seed) : state_(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // A quarter of the words are corner values or small numbers of either
+    // sign, where carries, sign bits and shift amounts go wrong
+    uint32_t word()
+    {
+        static const uint32_t CORNERS[] = {0x00000000, 0x00000001, 0x00000002, 0x0000001F, 0x00000020,
+                                           0x0000007F, 0x00000080, 0x000000FF, 0x00007FFF, 0x00008000,
+                                           0x0000FFFF, 0x7FFFFFFF, 0x80000000, 0x80000001, 0xFFFFFFFE,
+                                           0xFFFFFFFF, 0xFFFF0000, 0x55555555, 0xAAAAAAAA, 0xFF00FF00};
+        uint64_t r = next();
+        switch (r & 7)
+        {
+        case 0: return CORNERS[(r >> 3) % (sizeof(CORNERS) / sizeof(CORNERS[0]))];
+        case 1: return (r >> 3) & 0x3F;
+        default: return uint32_t(r >> 32);
+        }
+    }
+
+    // Second operand, often equal or adjacent to the first so the compares
+    // see both sides of every boundary
+    uint32_t near(uint32_t a)
+    {
+        switch (next() & 7)
+        {
+        case 0: return a;
+        case 1: return a + 1;
+        case 2: return a - 1;
+        case 3: return a ^ 0x80000000;
+        default: return word();
+        }
+    }
+
+private:
+    uint64_t state_;
+};
+
+static std::string hex(uint32_t value)
+{
+    char buf[11];
+    snprintf(buf, sizeof(buf), "0x%08x", value);
+    return buf;
+}
+
+// Each unit owns its model and one batch of inputs, reference outputs and
+// model outputs. fill() and reference() are the host side, simulate() the
+// model side, describe() formats a mismatching vector.
+class AluUnit
+{
+public:
+    static constexpr const char* NAME = "ALU";
+
+    explicit AluUnit(VerilatedContext* context) : model_(context) {}
+
+    void fill(VectorSource &src)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            a_[i] = src.word();
+            b_[i] = src.near(a_[i]);
+            ctrl_[i] = i & 15;
+            branch_[i] = (i >> 4) & 7;
+        }
+    }
+
+    void reference() { aluReference(a_, b_, ctrl_, branch_, ref_result_, ref_taken_, BATCH); }
+
+    void simulate()
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            model_.srcA_i = a_[i];
+            model_.srcB_i = b_[i];
+            model_.ALUCtrl_i = ctrl_[i];
+            model_.branch_i = branch_[i];
+            model_.eval();
+            result_[i] = model_.ALUResult_o;
+            taken_[i] = model_.branchTaken_o;
+        }
+    }
+
+    size_t mismatches() const
+    {
+        return countMismatches(result_, ref_result_, BATCH) + countMismatches(taken_, ref_taken_, BATCH);
+    }
+
+    bool differs(size_t i) const { return result_[i] != ref_result_[i] || taken_[i] != ref_taken_[i]; }
+
+    std::string describe(size_t i) const
+    {
+        return "srcA " + hex(a_[i]) + " srcB " + hex(b_[i]) + " ALUCtrl " + std::to_string(ctrl_[i]) + " branch " +
+               std::to_string(branch_[i]) + ": dut " + hex(result_[i]) + "/" + std::to_string(taken_[i]) + " ref " +
+               hex(ref_result_[i]) + "/" + std::to_string(ref_taken_[i]);
+    }
+
+private:
+    VALU model_;
+    alignas(64) uint32_t a_[BATCH], b_[BATCH], ctrl_[BATCH], branch_[BATCH];
+    alignas(64) uint32_t ref_result_[BATCH], ref_taken_[BATCH], result_[BATCH], taken_[BATCH];
+};
+
+class ExtendUnit
+{
+public:
+    static constexpr const char* NAME = "extend";
+
+    explicit ExtendUnit(VerilatedContext* context) : model_(context) {}
+
+    void fill(VectorSource &src)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            instr_[i] = src.word();
+            imm_src_[i] = i & 7;
+        }
+    }
+
+    void reference() { extendReference(instr_, imm_src_, ref_imm_, BATCH); }
+
+    void simulate()
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            model_.instr_i = instr_[i];
+            model_.ImmSrc_i = imm_src_[i];
+            model_.eval();
+            imm_[i] = model_.ImmExt_o;
+        }
+    }
+
+    size_t mismatches() const { return countMismatches(imm_, ref_imm_, BATCH); }
+
+    bool differs(size_t i) const { return imm_[i] != ref_imm_[i]; }
+
+    std::string describe(size_t i) const
+    {
+        return "instr " + hex(instr_[i]) + " ImmSrc " + std::to_string(imm_src_[i]) + ": dut " + hex(imm_[i]) +
+               " ref " + hex(ref_imm_[i]);
+    }
+
+private:
+    Vextend model_;
+    alignas(64) uint32_t instr_[BATCH], imm_src_[BATCH], ref_imm_[BATCH], imm_[BATCH];
+};
+
+class StoreMergeUnit
+{
+public:
+    static constexpr const char* NAME = "data_mem_i";
+
+    explicit StoreMergeUnit(VerilatedContext* context) : model_(context) {}
+
+    void fill(VectorSource &src)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            old_[i] = src.word();
+            data_[i] = src.word();
+            addr_[i] = (src.word() & ~3u) | ((i >> 2) & 3);
+            type_[i] = i & 3;
+        }
+    }
+
+    void reference() { storeMergeReference(old_, data_, addr_, type_, ref_merged_, BATCH); }
+
+    void simulate()
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            model_.read_data_i = old_[i];
+            model_.write_data_i = data_[i];
+            model_.addr_i = addr_[i];
+            model_.mem_type_i = type_[i];
+            model_.eval();
+            merged_[i] = model_.write_data_o;
+        }
+    }
+
+    size_t mismatches() const { return countMismatches(merged_, ref_merged_, BATCH); }
+
+    bool differs(size_t i) const { return merged_[i] != ref_merged_[i]; }
+
+    std::string describe(size_t i) const
+    {
+        return "read_data " + hex(old_[i]) + " write_data " + hex(data_[i]) + " addr " + hex(addr_[i]) +
+               " mem_type " + std::to_string(type_[i]) + ": dut " + hex(merged_[i]) + " ref " + hex(ref_merged_[i]);
+    }
+
+private:
+    Vdata_mem_i model_;
+    alignas(64) uint32_t old_[BATCH], data_[BATCH], addr_[BATCH], type_[BATCH], ref_merged_[BATCH], merged_[BATCH];
+};
+
+class LoadExtractUnit
+{
+public:
+    static constexpr const char* NAME = "data_mem_o";
+
+    explicit LoadExtractUnit(VerilatedContext* context) : model_(context) {}
+
+    void fill(VectorSource &src)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            word_[i] = src.word();
+            addr_[i] = (src.word() & ~3u) | ((i >> 3) & 3);
+            type_[i] = i & 3;
+            sign_[i] = (i >> 2) & 1;
+        }
+    }
+
+    void reference() { loadExtractReference(word_, addr_, type_, sign_, ref_loaded_, BATCH); }
+
+    void simulate()
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            model_.read_data_i = word_[i];
+            model_.addr_i = addr_[i];
+            model_.mem_type_i = type_[i];
+            model_.mem_sign_i = sign_[i];
+            model_.eval();
+            loaded_[i] = model_.read_data_o;
+        }
+    }
+
+    size_t mismatches() const { return countMismatches(loaded_, ref_loaded_, BATCH); }
+
+    bool differs(size_t i) const { return loaded_[i] != ref_loaded_[i]; }
+
+    std::string describe(size_t i) const
+    {
+        return "read_data " + hex(word_[i]) + " addr " + hex(addr_[i]) + " mem_type " + std::to_string(type_[i]) +
+               " mem_sign " + std::to_string(sign_[i]) + ": dut " + hex(loaded_[i]) + " ref " + hex(ref_loaded_[i]);
+    }
+
+private:
+    Vdata_mem_o model_;
+    alignas(64) uint32_t word_[BATCH], addr_[BATCH], type_[BATCH], sign_[BATCH], ref_loaded_[BATCH], loaded_[BATCH];
+};
+
+constexpr unsigned UNITS = 4;
+static const char* const UNIT_NAMES[UNITS] = {AluUnit::NAME, ExtendUnit::NAME, StoreMergeUnit::NAME,
+                                              LoadExtractUnit::NAME};
+
+// Shared between the threads: the next batch of every unit and the totals
+struct Progress
+{
+    std::atomic<uint64_t> next_batch[UNITS] = {};
+    std::atomic<uint64_t> vectors[UNITS] = {};
+    std::atomic<uint64_t> mismatches[UNITS] = {};
+    std::atomic<unsigned> reports{0};
+    std::mutex report_lock;
+};
+
+static bool outOfTime(const Options &opts, std::chrono::steady_clock::time_point start)
+{
+    return opts.seconds > 0 &&
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > opts.seconds;
+}
+
+// Runs one batch of unit number index, returns false once that unit has
+// done all its vectors
+template <class Unit>
+static bool runBatch(Unit &unit, unsigned index, const Options &opts, Progress &progress)
+{
+    uint64_t batch = progress.next_batch[index]++;
+    if (batch * BATCH >= opts.vectors) return false;
+
+    VectorSource src(opts.seed * 0x100000001B3ull + batch * UNITS + index);
+    unit.fill(src);
+    unit.reference();
+    unit.simulate();
+
+    size_t bad = unit.mismatches();
+    progress.vectors[index] += BATCH;
+    if (!bad) return true;
+
+    progress.mismatches[index] += bad;
+    for (size_t i = 0; i < BATCH; i++)
+    {
+        if (!unit.differs(i) || progress.reports++ >= MAX_REPORTS) continue;
+        std::lock_guard<std::mutex> lock(progress.report_lock);
+        std::cerr << "MISMATCH " << Unit::NAME << " " << unit.describe(i) << std::endl;
+    }
+    return true;
+}
+
+// One worker thread: its own context and one model per unit, interleaving
+// the units batch by batch until all of them are done
+static void worker(const Options &opts, Progress &progress, std::chrono::steady_clock::time_point start)
+{
+    VerilatedContext context;
+    auto alu = std::make_unique<AluUnit>(&context);
+    auto extend = std::make_unique<ExtendUnit>(&context);
+    auto store = std::make_unique<StoreMergeUnit>(&context);
+    auto load = std::make_unique<LoadExtractUnit>(&context);
+
+    bool active[UNITS];
+    for (unsigned u = 0; u < UNITS; u++) active[u] = opts.unit.empty() || opts.unit == UNIT_NAMES[u];
+
+    for (uint64_t round = 0;; round++)
+    {
+        if (round % 16 == 0 && outOfTime(opts, start)) break;
+        if (active[0]) active[0] = runBatch(*alu, 0, opts, progress);
+        if (active[1]) active[1] = runBatch(*extend, 1, opts, progress);
+        if (active[2]) active[2] = runBatch(*store, 2, opts, progress);
+        if (active[3]) active[3] = runBatch(*load, 3, opts, progress);
+        if (!active[0] && !active[1] && !active[2] && !active[3]) break;
+    }
+}
+
+static Options parseArgs(int argc, char** argv)
+{
+    Options opts;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "missing value for " << arg << std::endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--jobs") opts.jobs = std::stoul(next());
+        else if (arg == "--vectors") opts.vectors = std::stoull(next());
+        else if (arg == "--seconds") opts.seconds = std::stod(next());
+        else if (arg == "--seed") opts.seed = std::stoull(next());
+        else if (arg == "--unit") opts.unit = next();
+        else if (arg[0] != '+') // leave verilator plusargs alone
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            exit(2);
+        }
+    }
+    if (opts.jobs == 0) opts.jobs = 1;
+    if (!opts.unit.empty())
+    {
+        bool known = false;
+        for (const char* name : UNIT_NAMES) known |= opts.unit == name;
+        if (!known)
+        {
+            std::cerr << "unknown unit " << opts.unit << " (ALU, extend, data_mem_i, data_mem_o)" << std::endl;
+            exit(2);
+        }
+    }
+    return opts;
+}
+
+int main(int argc, char** argv)
+{
+    Verilated::commandArgs(argc, argv);
+    Options opts = parseArgs(argc, argv);
+    auto start = std::chrono::steady_clock::now();
+
+    Progress progress;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < opts.jobs; t++) threads.emplace_back(worker, std::cref(opts), std::ref(progress), start);
+    for (std::thread &thread : threads) thread.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t vectors = 0;
+    uint64_t mismatches = 0;
+    for (unsigned u = 0; u < UNITS; u++)
+    {
+        if (!progress.vectors[u]) continue;
+        std::cout << "difftest: " << std::left << std::setw(11) << UNIT_NAMES[u] << std::right << std::setw(12)
+                  << progress.vectors[u] << " vectors, " << progress.mismatches[u] << " mismatches" << std::endl;
+        vectors += progress.vectors[u];
+        mismatches += progress.mismatches[u];
+    }
+    std::cout << "difftest: " << vectors << " vectors in " << std::fixed << std::setprecision(2) << elapsed
+              << " s on " << opts.jobs << " threads, " << (vectors / elapsed / 1e6) << " M vectors/s" << std::endl;
+    if (mismatches)
+    {
+        std::cout << "difftest: " << mismatches << " mismatching outputs" << std::endl;
+        return 1;
+    }
+    std::cout << "difftest: no mismatches" << std::endl;
+    return 0;
+}
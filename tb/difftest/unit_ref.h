@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../common/rv32i.h"
+
+// Batched C++ references for the combinational units difftest.cpp drives.
+// Each kernel takes a structure of arrays and is written without branches
+// (selects, masks and shifts only) so the compiler turns the loop into SIMD
+// code; with -fopenmp-simd the pragmas make that a requirement rather than
+// a hope. The behaviour is taken from the RV32I spec and the control
+// encodings the control unit produces, not from the RTL, so a shared
+// misreading of the spec is the only thing the comparison can't catch.
+// Codes the control unit never produces give 0, like the RTL defaults.
+
+// ALU: ALUCtrl_i picks the result, branch_i (funct3 of the branch) the
+// comparison. Shifts use the low five bits of srcB.
+inline void aluReference(const uint32_t* a, const uint32_t* b, const uint32_t* ctrl, const uint32_t* branch,
+                         uint32_t* result, uint32_t* taken, size_t n)
+{
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t x = a[i];
+        uint32_t y = b[i];
+        uint32_t shamt = y & 31;
+        uint32_t lt = int32_t(x) < int32_t(y);
+        uint32_t ltu = x < y;
+        uint32_t eq = x == y;
+
+        uint32_t c = ctrl[i];
+        uint32_t r = 0;
+        r = c == 0 ? x + y : r;
+        r = c == 1 ? x - y : r;
+        r = c == 2 ? x & y : r;
+        r = c == 3 ? x | y : r;
+        r = c == 4 ? x ^ y : r;
+        r = c == 5 ? lt : r;
+        r = c == 6 ? ltu : r;
+        r = c == 7 ? x >> shamt : r;
+        r = c == 8 ? x << shamt : r;
+        r = c == 9 ? uint32_t(int32_t(x) >> shamt) : r;
+        result[i] = r;
+
+        uint32_t f3 = branch[i];
+        uint32_t t = 0;
+        t = f3 == 0 ? eq : t;      // beq
+        t = f3 == 1 ? eq ^ 1 : t;  // bne
+        t = f3 == 4 ? lt : t;      // blt
+        t = f3 == 5 ? lt ^ 1 : t;  // bge
+        t = f3 == 6 ? ltu : t;     // bltu
+        t = f3 == 7 ? ltu ^ 1 : t; // bgeu
+        taken[i] = t;
+    }
+}
+
+// extend: ImmSrc_i 0..4 = I, S, B, U, J immediates
+inline void extendReference(const uint32_t* instr, const uint32_t* imm_src, uint32_t* imm, size_t n)
+{
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t insn = instr[i];
+        uint32_t s = imm_src[i];
+        uint32_t r = 0;
+        r = s == 0 ? uint32_t(rv32i::immI(insn)) : r;
+        r = s == 1 ? uint32_t(rv32i::immS(insn)) : r;
+        r = s == 2 ? uint32_t(rv32i::immB(insn)) : r;
+        r = s == 3 ? uint32_t(rv32i::immU(insn)) : r;
+        r = s == 4 ? uint32_t(rv32i::immJ(insn)) : r;
+        imm[i] = r;
+    }
+}
+
+// data_mem_i: merges a store into the word read from memory. mem_type_i
+// 1 = byte, 2 = halfword at addr[1] (misaligned halves aren't split), anything
+// else stores the whole word.
+inline void storeMergeReference(const uint32_t* old_word, const uint32_t* store_data, const uint32_t* addr,
+                                const uint32_t* mem_type, uint32_t* merged, size_t n)
+{
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t t = mem_type[i];
+        uint32_t shift = t == 1 ? 8 * (addr[i] & 3) : 16 * ((addr[i] >> 1) & 1);
+        uint32_t mask = t == 1 ? 0xFFu : 0xFFFFu;
+        uint32_t partial = (old_word[i] & ~(mask << shift)) | ((store_data[i] & mask) << shift);
+        merged[i] = t == 1 || t == 2 ? partial : store_data[i];
+    }
+}
+
+// data_mem_o: picks the loaded byte/half out of the word and extends it.
+// mem_sign_i = 0 sign-extends (LB/LH), 1 zero-extends (LBU/LHU).
+inline void loadExtractReference(const uint32_t* word, const uint32_t* addr, const uint32_t* mem_type,
+                                 const uint32_t* mem_sign, uint32_t* loaded, size_t n)
+{
+#pragma omp simd
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t t = mem_type[i];
+        uint32_t width = t == 1 ? 8 : 16;
+        uint32_t shift = t == 1 ? 8 * (addr[i] & 3) : 16 * ((addr[i] >> 1) & 1);
+        // move the field to the top, then shift it back down arithmetically
+        // or logically
+        uint32_t top = (word[i] >> shift) << (32 - width);
+        uint32_t extended = mem_sign[i] ? top >> (32 - width) : uint32_t(int32_t(top) >> (32 - width));
+        loaded[i] = t == 1 || t == 2 ? extended : word[i];
+    }
+}
+
+// Number of positions where dut and ref differ
+inline size_t countMismatches(const uint32_t* dut, const uint32_t* ref, size_t n)
+{
+    size_t count = 0;
+#pragma omp simd reduction(+ : count)
+    for (size_t i = 0; i < n; i++) count += dut[i] != ref[i];
+    return count;
+}
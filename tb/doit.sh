@@ -57,7 +57,7 @@ for file in "${files[@]}"; do
     fi
     
     # we are testing the top module if working with any of these files
-    if [[ "$name" == "verify.cpp" || "$name" == "execute_pdf.cpp" || "$name" == "execute_f1.cpp" ]]; then
+    if [[ "$name" == "verify.cpp" || "$name" == "perf.cpp" || "$name" == "power.cpp" || "$name" == "execute_pdf.cpp" || "$name" == "execute_f1.cpp" ]]; then
         name="top"
     fi
 
@@ -73,6 +73,37 @@ for file in "${files[@]}"; do
         exit 1
     fi
     
+    # Optional build flavours, selected through the environment
+    # SPARSE_MEM=1 swaps data_mem for the C++ page-allocated model (data_mem_sparse.sv), its unit test always has it
+    # PIPELINED=1 builds the five stage core (top -GPIPELINED=1)
+    # COVERAGE=1 adds line, toggle and user coverage, each test writes a .dat under test_out/
+    # PROFILE=1 adds Verilator and gprof profiling plus harness phase timers (see profile.sh)
+    VFLAGS=()
+    CFLAGS="-std=c++17"
+    LDFLAGS="-L${GTEST_LIB} -lgtest -lgtest_main -lpthread"
+    if [[ "$SPARSE_MEM" == "1" || "$name" == "data_mem_sparse" ]]; then
+        VFLAGS+=(+define+SPARSE_MEM)
+        CFLAGS="$CFLAGS -DSPARSE_MEM"
+    fi
+    if [[ "$PIPELINED" == "1" && "$name" == "top" ]]; then
+        VFLAGS+=(-GPIPELINED=1)
+        CFLAGS="$CFLAGS -DPIPELINED"
+    fi
+    if [[ "$COVERAGE" == "1" ]]; then
+        VFLAGS+=(--coverage +define+COVERAGE)
+        CFLAGS="$CFLAGS -DCOVERAGE"
+    fi
+    # the energy estimate needs toggle counts, and only those
+    if [[ "$(basename "$file")" == "power.cpp" && "$COVERAGE" != "1" ]]; then
+        VFLAGS+=(--coverage-toggle)
+        CFLAGS="$CFLAGS -DCOVERAGE"
+    fi
+    if [[ "$PROFILE" == "1" ]]; then
+        VFLAGS+=(--prof-cfuncs --prof-exec -fno-inline)
+        CFLAGS="$CFLAGS -pg -DPROFILE"
+        LDFLAGS="$LDFLAGS -pg"
+    fi
+
     # Translate Verilog -> C++ including testbench
     # Note: -CFLAGS has quotes fixed and the backslash added
     verilator   -Wall --trace \
@@ -82,8 +113,9 @@ for file in "${files[@]}"; do
                 --prefix "Vdut" \
                 -o Vdut \
                 -Wno-UNUSED \
-                -CFLAGS "-std=c++17" \
-                -LDFLAGS "-L${GTEST_LIB} -lgtest -lgtest_main -lpthread"
+                "${VFLAGS[@]}" \
+                -CFLAGS "$CFLAGS" \
+                -LDFLAGS "$LDFLAGS"
                 > /dev/null
 
     # Build C++ project with automatically generated Makefile
@@ -94,7 +126,8 @@ for file in "${files[@]}"; do
     exit_code=$?
 
     # Print the output and filter out false memory preload warning
-    echo "$simulation_output" | grep -v "%Warning: data.hex:0: \$readmem file not found"
+    echo "$simulation_output" | grep -v "%Warning: data.hex:0: \$readmem file not found" \
+                              | grep -v "%Warning: data.hex:0: sparse_mem file not found"
 
     # Check if the test succeeded or not
     if [ $exit_code -eq 0 ]; then
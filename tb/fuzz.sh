@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# Builds and runs the differential fuzzing farm (fuzz/fuzz.cpp)
+# Usage: ./fuzz.sh [-G NAME=VALUE...] [--jobs N] [--programs N] [--seconds T] [--length L] [--seed S] [--out DIR]
+#                  [--no-minimize] [--fork-server]
+# -G overrides a top parameter, e.g. -G PIPELINED=1 -G DCACHE_BYTES=256 to fuzz the five stage core with a data cache
+
+# Constants
+SCRIPT_DIR=$(dirname "$(realpath "$0")")
+RTL_FOLDER=$(realpath "$SCRIPT_DIR/../rtl")
+BUILD_DIR="$SCRIPT_DIR/obj_fuzz"
+GREEN=$(tput setaf 2)
+RED=$(tput setaf 1)
+RESET=$(tput sgr0)
+
+cd "$SCRIPT_DIR" || exit
+
+# COVERAGE=1 builds the coverage model, each worker writes test_out/fuzz/coverage/worker<n>.dat
+VFLAGS=()
+CFLAGS="-std=c++17 -O2 -DSPARSE_MEM"
+ARGS=()
+while [[ $# -gt 0 ]]; do
+    if [[ "$1" == "-G" && $# -gt 1 ]]; then
+        VFLAGS+=("-G$2")
+        shift 2
+    else
+        ARGS+=("$1")
+        shift
+    fi
+done
+if [[ "$COVERAGE" == "1" ]]; then
+    VFLAGS+=(--coverage +define+COVERAGE)
+    CFLAGS="$CFLAGS -DCOVERAGE"
+fi
+
+# Translate Verilog -> C++ with the sparse data memory and no tracing, the
+# farm only looks at architectural state through the backdoor
+verilator   -Wall -O3 \
+            --x-assign fast --x-initial fast \
+            -cc "${RTL_FOLDER}/top.sv" \
+            --exe "$SCRIPT_DIR/fuzz/fuzz.cpp" \
+            -y "$RTL_FOLDER" \
+            --prefix "Vdut" \
+            -o Vfuzz \
+            --Mdir "$BUILD_DIR" \
+            -Wno-UNUSED \
+            +define+SPARSE_MEM \
+            "${VFLAGS[@]}" \
+            -CFLAGS "$CFLAGS" \
+            > /dev/null
+
+if ! make -j -C "$BUILD_DIR" -f Vdut.mk > /dev/null; then
+    echo "${RED}Error: failed to build the fuzz farm${RESET}"
+    exit 1
+fi
+
+# Run from an empty directory so the model doesn't preload program.hex/data.hex
+mkdir -p test_out/fuzz
+cd test_out/fuzz || exit
+"$BUILD_DIR/Vfuzz" --out "$PWD" "${ARGS[@]}" 2>&1 | grep -v "\$readmem file not found" | grep -v "sparse_mem file not found"
+exit_code=${PIPESTATUS[0]}
+
+if [ $exit_code -eq 0 ]; then
+    echo "${GREEN}Fuzzing finished with no mismatches${RESET}"
+else
+    echo "${RED}Fuzzing found mismatches, minimized reproducers are in test_out/fuzz${RESET}"
+fi
+exit $exit_code
@@ -0,0 +1,425 @@
+// Differential fuzzing farm: runs constrained-random RV32I programs on the
+// verilated top and on the C++ reference model, compares registers and the
+// data window once both reach the halt loop, and minimizes any mismatch.
+//
+// Built by fuzz.sh (top with SPARSE_MEM, no tracing, -G overrides passed on),
+// or by CMake as fuzz, fuzz_pipelined and fuzz_cached: the single cycle core,
+// the five stage one, and the five stage one with the data cache, victim
+// cache, store buffer, prefetcher, MSHRs and instruction cache. The reference
+// model is the same for all of them. One worker process per core, each
+// reusing a single model across programs through the backdoor.
+// With --fork-server the model is built and reset once and every program runs
+// in its own copy-on-write child instead (common/fork_server.h), so a program
+// that crashes or corrupts the model only loses itself.
+//
+// Usage: ./fuzz.sh [-G NAME=VALUE...] [--jobs N] [--programs N] [--seconds T]
+//                  [--length L] [--seed S] [--out DIR] [--no-minimize] [--fork-server]
+// --programs defaults to 10000, or no limit when --seconds is given.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "Vdut.h"
+#include "verilated.h"
+
+#include "../common/coverage.h"
+#include "../common/cpu_backdoor.h"
+#include "../common/fork_server.h"
+#include "../common/sparse_mem.h"
+#include "rv32i_gen.h"
+#include "rv32i_ref.h"
+
+#ifndef SPARSE_MEM
+#error "the fuzz farm compares against the sparse data memory, build it with fuzz.sh"
+#endif
+
+// cycles run after the halt loop is first fetched so a deeper pipeline drains,
+// along with the store buffer, deferred loads and a last writeback and refill
+#define HALT_DRAIN_CYCLES 64
+
+// a fork server job, minimizing included, that runs longer than this has
+// wedged the model and is killed
+#define FORK_JOB_SECONDS 60
+
+struct Options
+{
+    unsigned jobs = std::thread::hardware_concurrency();
+    uint64_t programs = 0; // 0 until parseArgs picks the default
+    double seconds = 0;
+    uint64_t seed = 1;
+    std::string out_dir = "test_out/fuzz";
+    bool minimize = true;
+    bool fork_server = false;
+    GenConfig gen;
+};
+
+struct WorkerStats
+{
+    uint64_t programs = 0;
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t failures = 0;
+};
+
+class FuzzWorker
+{
+public:
+    explicit FuzzWorker(const Options &opts) : opts_(opts), top_(&context_), backdoor_(&top_) {}
+
+    // Returns an empty string if the DUT matches the reference, otherwise a
+    // description of every mismatch
+    std::string check(const std::vector<uint32_t> &words, uint64_t* retired = nullptr)
+    {
+        RefCpu ref(words);
+        RefCpu::Status status = ref.run(words.size() + 1);
+        if (status != RefCpu::Status::Halted)
+            return "reference model did not reach the halt loop (status " + std::to_string(int(status)) + ")\n";
+        if (retired) *retired = ref.retired;
+
+        uint32_t halt_pc = rv32i::RESET_VECTOR + 4 * (words.size() - 1);
+        bool halted = runDut(words, halt_pc, ref.retired * 32 + 200);
+
+        std::ostringstream diff;
+        diff << std::hex << std::setfill('0');
+        if (!halted)
+            diff << "dut did not reach the halt loop, pc = 0x" << std::setw(8) << backdoor_.pc() << "\n";
+        for (unsigned r = 1; r < 32; r++)
+        {
+            if (backdoor_.reg(r) != ref.x[r])
+                diff << "x" << std::dec << r << std::hex << ": dut 0x" << std::setw(8) << backdoor_.reg(r)
+                     << " ref 0x" << std::setw(8) << ref.x[r] << "\n";
+        }
+        for (uint32_t i = 0; i < opts_.gen.data_size; i++)
+        {
+            uint32_t addr = opts_.gen.data_base + i;
+            if (backdoor_.readData(addr) != ref.mem.read8(addr))
+                diff << "mem[0x" << std::setw(8) << addr << "]: dut 0x" << std::setw(2) << int(backdoor_.readData(addr))
+                     << " ref 0x" << std::setw(2) << int(ref.mem.read8(addr)) << "\n";
+        }
+        return diff.str();
+    }
+
+    // What a mismatch is, without the values: its first line up to the
+    // values for a register or data byte, or all of it for a program that
+    // didn't halt (which keeps the PC it hung at)
+    static std::string failureClass(const std::string &diff)
+    {
+        std::string first = diff.substr(0, diff.find('\n'));
+        return first.substr(0, first.find(": dut"));
+    }
+
+    // Delta-debugging style reduction: replaces ever smaller chunks of the
+    // program with NOPs while it still fails the same way, so it can't wander
+    // off to a different bug. auipc/jalr pairs are removed together so the
+    // jalr never jumps off a stale base.
+    std::vector<uint32_t> minimize(const Program &prog, const std::string &diff)
+    {
+        const std::string target = failureClass(diff);
+        std::vector<uint32_t> words = prog.words;
+        size_t body = words.size() - 1; // never touch the halt loop
+
+        for (size_t chunk = body / 2; chunk >= 1; chunk /= 2)
+        {
+            for (size_t start = 0; start < body; start += chunk)
+            {
+                std::vector<uint32_t> candidate = words;
+                size_t first = start;
+                size_t last = std::min(body, start + chunk);
+                if (prog.glued[first] && first > 0) first--;
+                if (last < body && prog.glued[last]) last++;
+
+                bool changed = false;
+                for (size_t i = first; i < last; i++)
+                {
+                    changed |= candidate[i] != rv32i::NOP;
+                    candidate[i] = rv32i::NOP;
+                }
+                if (changed && failureClass(check(candidate)) == target) words = candidate;
+            }
+        }
+        return words;
+    }
+
+    const WorkerStats &stats() const { return stats_; }
+
+    // Holds the core in reset with empty registers and data memory. The next
+    // program only has to load its ROM, which is all a forked child does.
+    void reset()
+    {
+        top_.rst = 1;
+        tick();
+        backdoor_.clearRegs();
+        backdoor_.clearData();
+        pristine_ = true;
+    }
+
+    // The model accumulates over every program the worker ran, so the whole
+    // farm produces one coverage database per worker rather than per program
+    void writeCoverage(const std::string &path) { ::writeCoverage(&context_, path); }
+
+    void fuzz(uint64_t index)
+    {
+        ProgramGenerator gen(opts_.gen, opts_.seed + index);
+        Program prog = gen.generate();
+
+        uint64_t retired = 0;
+        std::string diff = check(prog.words, &retired);
+        stats_.programs++;
+        stats_.instructions += retired;
+        if (diff.empty()) return;
+
+        stats_.failures++;
+        std::string dir = opts_.out_dir + "/seed_" + std::to_string(prog.seed);
+        std::ignore = system(("mkdir -p " + dir).c_str());
+        writeHex(dir + "/program.hex", prog.words);
+        writeListing(dir + "/program.lst", prog.words, diff);
+
+        std::vector<uint32_t> reduced = opts_.minimize ? minimize(prog, diff) : prog.words;
+        std::string reduced_diff = check(reduced);
+        writeHex(dir + "/minimized.hex", reduced);
+        writeListing(dir + "/minimized.lst", reduced, reduced_diff);
+
+        std::cerr << "FAIL seed " << prog.seed << " -> " << dir << "/minimized.lst" << std::endl;
+    }
+
+private:
+    // Loads the program through the backdoor and runs it until the halt loop
+    bool runDut(const std::vector<uint32_t> &words, uint32_t halt_pc, uint64_t max_cycles)
+    {
+        if (!pristine_) reset();
+        pristine_ = false;
+        backdoor_.loadRom(words);
+        backdoor_.resync();
+        top_.rst = 0;
+
+        for (uint64_t cycle = 0; cycle < max_cycles; cycle++)
+        {
+            tick();
+            if (backdoor_.pc() == halt_pc)
+            {
+                for (int i = 0; i < HALT_DRAIN_CYCLES; i++) tick();
+                stats_.cycles += cycle + HALT_DRAIN_CYCLES;
+                return true;
+            }
+        }
+        stats_.cycles += max_cycles;
+        return false;
+    }
+
+    void tick()
+    {
+        top_.clk = 0;
+        top_.eval();
+        top_.clk = 1;
+        top_.eval();
+    }
+
+    // same byte-per-token layout assemble.sh produces, loadable by instrmem
+    static void writeHex(const std::string &path, const std::vector<uint32_t> &words)
+    {
+        std::ofstream file(path);
+        file << std::hex << std::setfill('0');
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            for (int b = 0; b < 4; b++)
+                file << std::setw(2) << ((words[i] >> (8 * b)) & 0xFF) << (b == 3 && (i & 3) == 3 ? "\n" : " ");
+        }
+        file << "\n";
+    }
+
+    static void writeListing(const std::string &path, const std::vector<uint32_t> &words, const std::string &diff)
+    {
+        std::ofstream file(path);
+        file << std::hex << std::setfill('0');
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            if (words[i] == rv32i::NOP) continue;
+            file << std::setw(8) << rv32i::RESET_VECTOR + 4 * i << ":  " << std::setw(8) << words[i] << "  "
+                 << rv32i::disasm(words[i]) << "\n";
+        }
+        file << "\nmismatches:\n" << diff;
+    }
+
+    const Options &opts_;
+    VerilatedContext context_;
+    Vdut top_;
+    CpuBackdoor backdoor_;
+    WorkerStats stats_;
+    bool pristine_ = false;
+};
+
+static Options parseArgs(int argc, char** argv)
+{
+    Options opts;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "missing value for " << arg << std::endl;
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--jobs") opts.jobs = std::stoul(next());
+        else if (arg == "--programs") opts.programs = std::stoull(next());
+        else if (arg == "--seconds") opts.seconds = std::stod(next());
+        else if (arg == "--length") opts.gen.length = std::stoul(next());
+        else if (arg == "--seed") opts.seed = std::stoull(next());
+        else if (arg == "--out") opts.out_dir = next();
+        else if (arg == "--no-minimize") opts.minimize = false;
+        else if (arg == "--fork-server") opts.fork_server = true;
+        else if (arg[0] != '+') // leave verilator plusargs alone
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            exit(2);
+        }
+    }
+    if (opts.jobs == 0) opts.jobs = 1;
+    // a timed run goes on until the time is up unless it's also given a count
+    if (opts.programs == 0) opts.programs = opts.seconds > 0 ? UINT64_MAX : 10000;
+    // program plus prologue and halt loop have to fit in the 4KB ROM
+    size_t max_length = CpuBackdoor::ROM_BYTES / 4 - ProgramGenerator::prologueSize() - 2;
+    if (opts.gen.length > max_length) opts.gen.length = max_length;
+    return opts;
+}
+
+static bool outOfTime(const Options &opts, std::chrono::steady_clock::time_point start)
+{
+    return opts.seconds > 0 &&
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > opts.seconds;
+}
+
+static int report(const Options &opts, const WorkerStats &total, std::chrono::steady_clock::time_point start)
+{
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "fuzz: " << total.programs << " programs, " << total.instructions << " instructions, "
+              << total.cycles << " cycles in " << std::fixed << std::setprecision(2) << elapsed << " s on "
+              << opts.jobs << " workers" << std::endl;
+    std::cout << "fuzz: " << (total.instructions / elapsed / 1e6) << " M instructions/s, "
+              << (total.cycles / elapsed / 1e6) << " M cycles/s" << std::endl;
+    if (total.failures)
+    {
+        std::cout << "fuzz: " << total.failures << " failing programs, see " << opts.out_dir << std::endl;
+        return 1;
+    }
+    std::cout << "fuzz: no mismatches" << std::endl;
+    return 0;
+}
+
+static void add(WorkerStats &total, const WorkerStats &stats)
+{
+    total.programs += stats.programs;
+    total.instructions += stats.instructions;
+    total.cycles += stats.cycles;
+    total.failures += stats.failures;
+}
+
+// One model for the whole run, reset here and never clocked again: every
+// program runs in a child forked from it. Coverage isn't collected in this
+// mode, each child's counts die with it.
+static int runForkServer(const Options &opts, std::chrono::steady_clock::time_point start)
+{
+    FuzzWorker worker(opts);
+    worker.reset();
+
+    WorkerStats total;
+    ForkServer server(opts.jobs, [&](const ForkServer::Result &result) {
+        WorkerStats stats;
+        if (result.ok && result.data.size() == sizeof(stats))
+        {
+            memcpy(&stats, result.data.data(), sizeof(stats));
+            add(total, stats);
+            return;
+        }
+        std::cerr << "program " << result.id << " (seed " << opts.seed + result.id << ") "
+                  << (result.timed_out ? "wedged" : "crashed") << " the model" << std::endl;
+        total.failures++;
+    }, FORK_JOB_SECONDS);
+    for (uint64_t i = 0; i < opts.programs; i++)
+    {
+        if (i % 64 == 0 && outOfTime(opts, start)) break;
+        server.submit(i, [&worker, i]() {
+            worker.fuzz(i);
+            return std::string(reinterpret_cast<const char*>(&worker.stats()), sizeof(WorkerStats));
+        });
+    }
+    server.finish();
+
+    std::cout << "fuzz: fork server started " << server.forks() << " jobs, " << std::fixed << std::setprecision(1)
+              << server.meanForkMicros() << " us per fork" << std::endl;
+    return report(opts, total, start);
+}
+
+int main(int argc, char** argv)
+{
+    Verilated::commandArgs(argc, argv);
+    Options opts = parseArgs(argc, argv);
+    auto start = std::chrono::steady_clock::now();
+    if (opts.fork_server) return runForkServer(opts, start);
+
+    // fork the workers before any model exists, each one owns its model and
+    // the process-wide sparse memory behind the DPI calls
+    std::vector<pid_t> pids;
+    std::vector<int> pipes;
+    for (unsigned w = 0; w < opts.jobs; w++)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            perror("pipe");
+            return 2;
+        }
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            FuzzWorker worker(opts);
+            for (uint64_t i = w; i < opts.programs; i += opts.jobs)
+            {
+                worker.fuzz(i);
+                if ((i / opts.jobs) % 64 == 0 && outOfTime(opts, start)) break;
+            }
+            worker.writeCoverage(opts.out_dir + "/coverage/worker" + std::to_string(w) + ".dat");
+            std::ignore = write(fds[1], &worker.stats(), sizeof(WorkerStats));
+            close(fds[1]);
+            _exit(0);
+        }
+        close(fds[1]);
+        pids.push_back(pid);
+        pipes.push_back(fds[0]);
+    }
+
+    WorkerStats total;
+    for (size_t w = 0; w < pids.size(); w++)
+    {
+        WorkerStats stats;
+        if (read(pipes[w], &stats, sizeof(stats)) == sizeof(stats))
+        {
+            add(total, stats);
+        }
+        else
+        {
+            std::cerr << "worker " << w << " died" << std::endl;
+            total.failures++;
+        }
+        close(pipes[w]);
+        waitpid(pids[w], nullptr, 0);
+    }
+
+    return report(opts, total, start);
+}
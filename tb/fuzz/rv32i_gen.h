@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../common/rv32i.h"
+
+// Constrained-random RV32I program generator.
+//
+// Programs are built so they always terminate and never leave the ROM:
+// control flow only goes forward, every jalr is preceded by the auipc that
+// sets up its base, and the last instruction is the `jal x0, 0` halt loop.
+// Loads and stores are naturally aligned and stay inside a data window
+// addressed off x31, which random instructions never write.
+struct GenConfig
+{
+    unsigned length = 200;          // random body instructions
+    uint32_t data_base = 0x00100000;
+    uint32_t data_size = 2048;      // window reachable with a 12-bit offset
+    // relative weights of each instruction class
+    unsigned w_alu_reg = 30;
+    unsigned w_alu_imm = 30;
+    unsigned w_upper = 6;
+    unsigned w_load = 14;
+    unsigned w_store = 10;
+    unsigned w_branch = 8;
+    unsigned w_jump = 2;
+};
+
+struct Program
+{
+    std::vector<uint32_t> words;
+    // words that must not be the target of a branch or the first word of a
+    // minimization chunk on their own (second half of auipc/jalr pairs)
+    std::vector<bool> glued;
+    uint64_t seed = 0;
+};
+
+class ProgramGenerator
+{
+public:
+    static constexpr uint32_t BASE_REG = 31;
+
+    ProgramGenerator(const GenConfig &config, uint64_t seed) : cfg_(config), rng_(seed), seed_(seed) {}
+
+    Program generate()
+    {
+        using namespace rv32i;
+        Program prog;
+        prog.seed = seed_;
+        words_.clear();
+        glued_.clear();
+        fixups_.clear();
+
+        // prologue: data base pointer, then random register contents
+        emit(encU(OP_LUI, BASE_REG, cfg_.data_base >> 12));
+        for (uint32_t r = 1; r < BASE_REG; r++)
+        {
+            uint32_t value = randomValue();
+            emit(encU(OP_LUI, r, (value + 0x800) >> 12));
+            emit(encI(OP_IMM, r, 0, r, int32_t(value << 20) >> 20));
+        }
+
+        unsigned total = cfg_.w_alu_reg + cfg_.w_alu_imm + cfg_.w_upper + cfg_.w_load + cfg_.w_store + cfg_.w_branch +
+                         cfg_.w_jump;
+        while (words_.size() < prologueSize() + cfg_.length)
+        {
+            unsigned pick = uniform(total);
+            if (pick < cfg_.w_alu_reg) aluReg();
+            else if ((pick -= cfg_.w_alu_reg) < cfg_.w_alu_imm) aluImm();
+            else if ((pick -= cfg_.w_alu_imm) < cfg_.w_upper) upper();
+            else if ((pick -= cfg_.w_upper) < cfg_.w_load) load();
+            else if ((pick -= cfg_.w_load) < cfg_.w_store) store();
+            else if ((pick -= cfg_.w_store) < cfg_.w_branch) branch();
+            else jump();
+        }
+
+        // halt loop
+        emit(encJ(0, 0));
+        resolveFixups();
+
+        prog.words = words_;
+        prog.glued = glued_;
+        return prog;
+    }
+
+    static size_t prologueSize() { return 1 + 2 * (BASE_REG - 1); }
+
+private:
+    enum class FixKind { Branch, Jal, Jalr };
+    struct Fixup
+    {
+        size_t index;
+        FixKind kind;
+    };
+
+    void emit(uint32_t word, bool glued = false)
+    {
+        words_.push_back(word);
+        glued_.push_back(glued);
+    }
+
+    unsigned uniform(unsigned n) { return std::uniform_int_distribution<unsigned>(0, n - 1)(rng_); }
+    uint32_t anyReg() { return uniform(32); }
+    uint32_t destReg() { return uniform(BASE_REG); } // x0..x30, x0 writes are legal and ignored
+
+    // biased towards corner cases that shake out sign and width bugs
+    uint32_t randomValue()
+    {
+        static const uint32_t corners[] = {0, 1, 0xFFFFFFFF, 0x7FFFFFFF, 0x80000000, 0xFF, 0x80, 0xFFFF, 0x8000, 0x7FF, 0x800};
+        if (uniform(4) == 0) return corners[uniform(sizeof(corners) / sizeof(corners[0]))];
+        return std::uniform_int_distribution<uint32_t>()(rng_);
+    }
+
+    int32_t imm12()
+    {
+        static const int32_t corners[] = {0, 1, -1, 2047, -2048, 31, 32};
+        if (uniform(4) == 0) return corners[uniform(sizeof(corners) / sizeof(corners[0]))];
+        return int32_t(uniform(4096)) - 2048;
+    }
+
+    void aluReg()
+    {
+        using namespace rv32i;
+        uint32_t f3 = uniform(8);
+        uint32_t f7 = ((f3 == 0 || f3 == 5) && uniform(2)) ? 0x20 : 0;
+        emit(encR(OP_REG, destReg(), f3, anyReg(), anyReg(), f7));
+    }
+
+    void aluImm()
+    {
+        using namespace rv32i;
+        uint32_t f3 = uniform(8);
+        int32_t imm = imm12();
+        if (f3 == 1) imm = uniform(32);
+        if (f3 == 5) imm = uniform(32) | (uniform(2) ? 0x400 : 0);
+        emit(encI(OP_IMM, destReg(), f3, anyReg(), imm));
+    }
+
+    void upper()
+    {
+        using namespace rv32i;
+        emit(encU(uniform(2) ? OP_LUI : OP_AUIPC, destReg(), randomValue() >> 12));
+    }
+
+    // offset into the data window, aligned to the access size
+    int32_t dataOffset(unsigned size) { return uniform(cfg_.data_size / size) * size; }
+
+    void load()
+    {
+        using namespace rv32i;
+        static const uint32_t f3s[] = {0, 1, 2, 4, 5};
+        uint32_t f3 = f3s[uniform(5)];
+        unsigned size = 1u << (f3 & 3);
+        emit(encI(OP_LOAD, destReg(), f3, BASE_REG, dataOffset(size)));
+    }
+
+    void store()
+    {
+        using namespace rv32i;
+        uint32_t f3 = uniform(3);
+        emit(encS(f3, BASE_REG, anyReg(), dataOffset(1u << f3)));
+    }
+
+    void branch()
+    {
+        using namespace rv32i;
+        static const uint32_t f3s[] = {0, 1, 4, 5, 6, 7};
+        fixups_.push_back({words_.size(), FixKind::Branch});
+        emit(encB(f3s[uniform(6)], anyReg(), anyReg(), 0));
+    }
+
+    void jump()
+    {
+        using namespace rv32i;
+        if (uniform(2))
+        {
+            fixups_.push_back({words_.size(), FixKind::Jal});
+            emit(encJ(destReg(), 0));
+            return;
+        }
+        // auipc t, 0 ; jalr rd, off(t) with off resolved to a later instruction
+        uint32_t base = 1 + uniform(BASE_REG - 1);
+        emit(encU(OP_AUIPC, base, 0));
+        fixups_.push_back({words_.size(), FixKind::Jalr});
+        emit(encI(OP_JALR, destReg(), 0, base, 0), true);
+    }
+
+    // Points every forward transfer at a random legal landing slot within
+    // the next 16 instructions (or the halt loop)
+    void resolveFixups()
+    {
+        using namespace rv32i;
+        size_t last = words_.size() - 1;
+        for (const Fixup &fix : fixups_)
+        {
+            size_t target;
+            do
+            {
+                target = std::min(last, fix.index + 1 + uniform(16));
+            } while (glued_[target]);
+
+            int32_t offset = int32_t(target - fix.index) * 4;
+            uint32_t &word = words_[fix.index];
+            switch (fix.kind)
+            {
+            case FixKind::Branch: word = encB(funct3(word), rs1(word), rs2(word), offset); break;
+            case FixKind::Jal: word = encJ(rd(word), offset); break;
+            case FixKind::Jalr: word = encI(OP_JALR, rd(word), 0, rs1(word), offset + 4); break;
+            }
+        }
+    }
+
+    GenConfig cfg_;
+    std::mt19937_64 rng_;
+    uint64_t seed_;
+    std::vector<uint32_t> words_;
+    std::vector<bool> glued_;
+    std::vector<Fixup> fixups_;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/rv32i.h"
+#include "../common/sparse_mem.h"
+
+// Instruction-accurate RV32I reference model of the core's architectural
+// state. Harvard like the RTL: instructions come from a ROM image at the
+// reset vector, loads and stores go to a separate sparse data memory.
+class RefCpu
+{
+public:
+    enum class Status { Running, Halted, BadFetch, Illegal };
+
+    explicit RefCpu(const std::vector<uint32_t> &rom) : rom_(rom) { reset(); }
+
+    void reset()
+    {
+        pc = rv32i::RESET_VECTOR;
+        for (auto &r : x) r = 0;
+        mem.clear();
+        retired = 0;
+    }
+
+    // Executes one instruction. A jump or branch to itself is the halt idiom
+    // used by every test program, so it is reported instead of executed.
+    Status step()
+    {
+        uint32_t index = (pc - rv32i::RESET_VECTOR) >> 2;
+        if ((pc & 3) || index >= rom_.size()) return Status::BadFetch;
+
+        using namespace rv32i;
+        uint32_t insn = rom_[index];
+        uint32_t a = x[rs1(insn)];
+        uint32_t b = x[rs2(insn)];
+        uint32_t f3 = funct3(insn);
+        uint32_t next = pc + 4;
+        uint32_t result = 0;
+        bool write = true;
+
+        switch (opcode(insn))
+        {
+        case OP_REG:
+            result = alu(f3, a, b, (insn >> 30) & 1);
+            break;
+        case OP_IMM:
+            // bit 30 only selects srai, addi with a negative immediate is still an add
+            result = alu(f3, a, immI(insn), f3 == 5 && ((insn >> 30) & 1));
+            break;
+        case OP_LUI:
+            result = immU(insn);
+            break;
+        case OP_AUIPC:
+            result = pc + immU(insn);
+            break;
+        case OP_LOAD:
+        {
+            uint32_t addr = a + immI(insn);
+            switch (f3)
+            {
+            case 0: result = int32_t(int8_t(mem.read8(addr))); break;
+            case 1: result = int32_t(int16_t(mem.read8(addr) | (mem.read8(addr + 1) << 8))); break;
+            case 2: result = mem.read32(addr); break;
+            case 4: result = mem.read8(addr); break;
+            case 5: result = mem.read8(addr) | (mem.read8(addr + 1) << 8); break;
+            default: return Status::Illegal;
+            }
+            break;
+        }
+        case OP_STORE:
+        {
+            uint32_t addr = a + immS(insn);
+            switch (f3)
+            {
+            case 0: mem.write8(addr, b); break;
+            case 1: mem.write8(addr, b); mem.write8(addr + 1, b >> 8); break;
+            case 2: mem.write32(addr, b); break;
+            default: return Status::Illegal;
+            }
+            write = false;
+            break;
+        }
+        case OP_BRANCH:
+        {
+            bool taken;
+            switch (f3)
+            {
+            case 0: taken = a == b; break;
+            case 1: taken = a != b; break;
+            case 4: taken = int32_t(a) < int32_t(b); break;
+            case 5: taken = int32_t(a) >= int32_t(b); break;
+            case 6: taken = a < b; break;
+            case 7: taken = a >= b; break;
+            default: return Status::Illegal;
+            }
+            if (taken) next = pc + immB(insn);
+            write = false;
+            break;
+        }
+        case OP_JAL:
+            result = pc + 4;
+            next = pc + immJ(insn);
+            break;
+        case OP_JALR:
+            result = pc + 4;
+            next = (a + immI(insn)) & ~1u;
+            break;
+        default:
+            return Status::Illegal;
+        }
+
+        if (next == pc) return Status::Halted;
+
+        if (write && rd(insn) != 0) x[rd(insn)] = result;
+        pc = next;
+        retired++;
+        return Status::Running;
+    }
+
+    // Runs to the halt loop, giving up after max_steps
+    Status run(uint64_t max_steps)
+    {
+        Status status = Status::Running;
+        for (uint64_t i = 0; i < max_steps && status == Status::Running; i++)
+            status = step();
+        return status;
+    }
+
+    uint32_t pc;
+    uint32_t x[32];
+    SparseMem mem;
+    uint64_t retired;
+
+private:
+    static uint32_t alu(uint32_t f3, uint32_t a, uint32_t b, bool alt)
+    {
+        switch (f3)
+        {
+        case 0: return alt ? a - b : a + b;
+        case 1: return a << (b & 31);
+        case 2: return int32_t(a) < int32_t(b);
+        case 3: return a < b;
+        case 4: return a ^ b;
+        case 5: return alt ? uint32_t(int32_t(a) >> (b & 31)) : a >> (b & 31);
+        case 6: return a | b;
+        default: return a & b;
+        }
+    }
+
+    const std::vector<uint32_t> &rom_;
+};
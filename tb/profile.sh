@@ -0,0 +1,94 @@
+#!/bin/bash
+
+# Profiling build of the perf workloads (program_tests/perf.cpp): verilates top
+# with --prof-cfuncs and --prof-exec, builds everything with gprof
+# instrumentation, runs the workloads and writes test_out/profile/report.txt,
+# which attributes host time to RTL modules and to harness phases
+# Usage: ./profile.sh [--binary <perf built with -DRISKV_PROFILE=ON>] [--out DIR] [gtest flags]
+
+# Constants
+SCRIPT_DIR=$(dirname "$(realpath "$0")")
+RTL_FOLDER=$(realpath "$SCRIPT_DIR/../rtl")
+BUILD_DIR="$SCRIPT_DIR/obj_profile"
+# GoogleTest's library directory, from pkg-config or the compiler's search path unless GTEST_LIB is set
+if [[ -z "$GTEST_LIB" ]]; then
+    GTEST_LIB=$(pkg-config --variable=libdir gtest 2>/dev/null)
+    [[ -n "$GTEST_LIB" ]] || GTEST_LIB=$(dirname "$(g++ -print-file-name=libgtest.a)")
+fi
+RED=$(tput setaf 1)
+RESET=$(tput sgr0)
+
+out_dir="$SCRIPT_DIR/test_out/profile"
+binary=""
+args=()
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        --binary) binary=$(realpath "$2"); shift 2 ;;
+        --out) out_dir=$(realpath -m "$2"); shift 2 ;;
+        *) args+=("$1"); shift ;;
+    esac
+done
+
+cd "$SCRIPT_DIR" || exit
+
+if [[ -z "$binary" ]]; then
+    # -fno-inline keeps every RTL module in its own functions, so time can be
+    # attributed to controlunit, ALU, data_mem... rather than all to top
+    verilator   -Wall --trace -O3 \
+                --prof-cfuncs --prof-exec -fno-inline \
+                -cc "${RTL_FOLDER}/top.sv" \
+                --exe "$SCRIPT_DIR/program_tests/perf.cpp" \
+                -y "$RTL_FOLDER" \
+                --prefix "Vdut" \
+                -o Vperf \
+                --Mdir "$BUILD_DIR" \
+                -Wno-UNUSED \
+                -CFLAGS "-std=c++17 -O2 -pg -DPROFILE" \
+                -LDFLAGS "-pg -L${GTEST_LIB} -lgtest -lpthread" \
+                > /dev/null
+
+    if ! make -j -C "$BUILD_DIR" -f Vdut.mk > /dev/null; then
+        echo "${RED}Error: failed to build the profiling model${RESET}"
+        exit 1
+    fi
+    binary="$BUILD_DIR/Vperf"
+fi
+
+# Runs from tb/ like doit.sh, gmon.out is written here when the binary exits.
+# The model's clock never advances $time, so the execution trace starts at 0
+# and covers a window of eval() calls of the last workload.
+mkdir -p "$out_dir"
+rm -f gmon.out "$out_dir/profile_exec.dat"
+"$binary" "${args[@]}" \
+    +verilator+prof+exec+start+0 +verilator+prof+exec+window+2000 \
+    +verilator+prof+exec+file+"$out_dir/profile_exec.dat" > "$out_dir/perf.txt" 2>&1
+mv gmon.out "$out_dir/gmon.out" 2>/dev/null
+
+cd "$out_dir" || exit
+if [[ ! -f gmon.out ]]; then
+    echo "${RED}Error: no gmon.out, was $binary built with -pg?${RESET}"
+    exit 1
+fi
+gprof -b "$binary" gmon.out > gprof.txt
+verilator_profcfunc gprof.txt > profcfunc.txt
+[[ -f profile_exec.dat ]] && verilator_gantt --no-vcd profile_exec.dat > gantt.txt
+
+{
+    echo "RISKV simulator profile: $binary"
+    echo
+    echo "== Host time by RTL module and statement (verilator_profcfunc) =="
+    cat profcfunc.txt
+    echo
+    echo "== Hottest host functions, model and harness (gprof flat profile) =="
+    sed -n '/^Flat profile/,/^$/p;/^  %/,/^$/p' gprof.txt | head -30
+    echo
+    sed -n '/^harness phases/,/^$/p' perf.txt
+    if [[ -f gantt.txt ]]; then
+        echo
+        echo "== Eval execution trace (verilator_gantt) =="
+        cat gantt.txt
+    fi
+} > report.txt
+
+cat report.txt
+echo "Report in $out_dir/report.txt, raw data alongside it"
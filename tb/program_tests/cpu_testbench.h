@@ -1,99 +1,277 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "Vdut.h"
+#include "Vdut___024root.h"
 #include "verilated.h"
 #include "verilated_vcd_c.h"
 #include "gtest/gtest.h"
 
+#include "../common/coverage.h"
+#include "../common/kanata.h"
+#include "../common/loop_skip.h"
+#include "../common/phase_profile.h"
+#include "../common/telemetry.h"
+#ifdef SPARSE_MEM
+#include "../common/sparse_mem.h"
+#endif
+
 #define MAX_SIM_CYCLES 10000
 
+// Folder holding assemble.sh, asm/ and reference/. The CMake build points it at
+// the source tree, doit.sh runs from tb/ so the default works there.
+#ifndef TB_DIR
+#define TB_DIR "."
+#endif
+
 class CpuTestbench : public ::testing::Test
 {
 public:
+    // A word the program stored to the output FIFO (rtl/io_port.sv), and the
+    // cycle the harness took it in, one after the store if out_ready was high
+    struct OutputEvent
+    {
+        uint64_t cycle;
+        uint32_t data;
+    };
+
+    // main() passes its arguments on so every test's context sees the plusargs
+    static void setArgs(int argc, char** argv)
+    {
+        argc_ = argc;
+        argv_ = const_cast<const char**>(argv);
+    }
+
     void SetUp() override
     {
         // Create new context for simulation
         context_ = new VerilatedContext;
+        if (argv_) context_->commandArgs(argc_, argv_);
+        both_edges_ = context_->commandArgsPlusMatch("both_edges")[0] != '\0';
+        loop_skip_ = context_->commandArgsPlusMatch("no_loop_skip")[0] == '\0';
+        // +kanata_start=<cycle> and/or +kanata_cycles=<n> write pipeline.kanata
+        kanata_start_ = plusargNumber("kanata_start=", 0);
+        kanata_cycles_ = plusargNumber("kanata_cycles=", 0);
+        // progress on stderr every +telemetry=<n> cycles (0 turns it off), and
+        // Prometheus metrics in +telemetry_file=<path>
+        telemetry_interval_ = plusargNumber("telemetry=", 1000000);
+        const char* metrics = context_->commandArgsPlusMatch("telemetry_file=");
+        telemetry_file_ = metrics[0] ? metrics + strlen("+telemetry_file=") : "";
         ticks_ = 0;
+        tb_dir_ = std::filesystem::absolute(TB_DIR).string();
+        start_dir_ = std::filesystem::current_path();
     }
 
-    void setupTest(const std::string &name)
+    void setupTest(const std::string &name, const std::string &dir = "")
     {
         name_ = name;
+        // Each test runs inside its own test_out/<name> folder, which is where
+        // instrmem and data_mem pick up program.hex and data.hex. This keeps
+        // tests from sharing files so ctest can run them in parallel. Tests
+        // that run the same program pass their own folder name.
+        std::filesystem::path work_dir = start_dir_ / "test_out" / (dir.empty() ? name_ : dir);
+        std::filesystem::create_directories(work_dir);
+        std::filesystem::current_path(work_dir);
+
         // Assemble the program
-        std::ignore = system(("./assemble.sh asm/" + name_ + ".s").c_str());
+        PROFILE_PHASE("assemble");
+        std::ignore = system((tb_dir_ + "/assemble.sh " + tb_dir_ + "/asm/" + name_ + ".s .").c_str());
         // Create default empty file for data memory
-        std::ignore = system("touch data.hex");
+        std::ignore = system("rm -f data.hex && touch data.hex");
     }
 
     // CPU instantiated outside of SetUp to allow for correct
     // program to be assembled and loaded into instruction memory
     void initSimulation()
     {
+        PROFILE_PHASE("build model");
         top_ = new Vdut(context_);
-        tfp_ = new VerilatedVcdC;
 
-        // Initialise trace and simulation
+        // Initialise trace and simulation, a model verilated without --trace
+        // (sweep.sh, for an undisturbed simulated speed) runs without one
+#if VM_TRACE
+        tfp_ = new VerilatedVcdC;
         Verilated::traceEverOn(true);
         top_->trace(tfp_, 99);
-        tfp_->open(("test_out/" + name_ + "/waveform.vcd").c_str());
+        tfp_->open("waveform.vcd");
+#endif
 
         // Initialise inputs
         top_->clk = 1;
         top_->rst = 1;
         top_->trigger = 0;
+        top_->out_ready = 1; // the harness takes every output word straight away
         runSimulation(10);  // Process reset
         top_->rst = 0;
+        if (loop_skip_) skipper_ = std::make_unique<LoopSkipper>(top_);
+        if (kanata_start_ || kanata_cycles_)
+            kanata_ = std::make_unique<KanataLog>(top_, "pipeline.kanata", kanata_start_,
+                                                  kanata_cycles_ ? kanata_cycles_ : 1000);
+        if (telemetry_interval_)
+        {
+            telemetry_ = std::make_unique<Telemetry>(top_, name_, telemetry_interval_, telemetry_file_);
+            telemetry_->loadSymbols("program.dis");
+        }
     }
 
-    // Runs the simulation for a clock cycle, evaluates the DUT, dumps waveform.
+    // Countdown delay loops (single cycle core only) and the halt loop are
+    // skipped analytically unless this is turned off (or +no_loop_skip is given). Cycle counts stay exact,
+    // the waveform has no samples for the skipped cycles.
+    void setLoopSkip(bool enable) { loop_skip_ = enable; }
+
+    // Runs the simulation for a number of clock cycles, evaluates the DUT,
+    // dumps waveform (see step())
     void runSimulation(int cycles = 1)
     {
-        for (int i = 0; i < cycles; i++)
+        for (uint64_t i = 0; i < uint64_t(cycles);)
         {
-            for (int clk = 0; clk < 2; clk++)
-            {
-                top_->eval();
-                tfp_->dump(2 * ticks_ + clk);
-                top_->clk = !top_->clk;
-            }
-            ticks_++;
-
-            if (Verilated::gotFinish())
+            // nothing changes in the halt loop once the output FIFO can't
+            // drain (empty, or out_ready low), so the rest of the run is free
+            if (skipper_ && halted() && !(top_->out_valid && top_->out_ready))
             {
-                exit(0);
+                ticks_ += cycles - i;
+                return;
             }
+            i += step(cycles - i);
         }
     }
 
+    // Performance counters and halt probe in top.sv. They freeze the first
+    // time the core executes its halt loop (a taken branch/jump to itself).
+    uint64_t cycles() const { return top_->rootp->top__DOT__mcycle; }
+    uint64_t instret() const { return top_->rootp->top__DOT__minstret; }
+    bool halted() const { return top_->rootp->top__DOT__halted; }
+
+    // Every word the program has written to the output FIFO so far
+    const std::vector<OutputEvent> &outputs() const { return outputs_; }
+
+    // Runs until the halt loop or max_cycles, returns whether it halted
+    bool runUntilHalt(uint64_t max_cycles)
+    {
+        for (uint64_t i = 0; i < max_cycles && !halted();)
+            i += step(max_cycles - i);
+        return halted();
+    }
+
     void TearDown() override
     {
+        PROFILE_PHASE("teardown");
+        if (skipper_ && skipper_->loops())
+            std::cout << "loop skip: " << skipper_->loops() << " loops, " << skipper_->skippedCycles()
+                      << " cycles skipped" << std::endl;
+        skipper_.reset();
+        kanata_.reset();
+        telemetry_.reset();
+
         // End trace and simulation
         top_->final();
-        tfp_->close();
+        if (tfp_) tfp_->close();
+        // test_out/<name>/coverage.dat (coverage build only)
+        writeCoverage(context_, "coverage.dat");
 
         // Free memory
         if (top_) delete top_;
         if (tfp_) delete tfp_;
         delete context_;
 
-        // Save data and program memory files to test_out directory
-        std::ignore = system(("mv data.hex test_out/" + name_ + "/data.hex").c_str());
-        std::ignore = system(("mv program.hex test_out/" + name_ + "/program.hex").c_str());
+#ifdef SPARSE_MEM
+        // the sparse model outlives the DUT, so report and reset it per test
+        sparseMem().printStats(std::cout);
+        sparseMem().clear();
+#endif
+
+        // data and program memory files are left in test_out/<name>
+        std::filesystem::current_path(start_dir_);
     }
 
     void setData(const std::string &data_file)
     {
-        // Fill data.hex with program data
-        std::ignore = system(("cp " + data_file + " data.hex").c_str());
+        // Fill data.hex with program data, relative paths are from tb/
+        std::string path = data_file[0] == '/' ? data_file : tb_dir_ + "/" + data_file;
+        std::ignore = system(("cp " + path + " data.hex").c_str());
     }
 
 protected:
+    // One clock cycle, then whatever is left of a countdown loop within the
+    // budget. Returns the number of cycles that passed. The core is posedge
+    // only, so by default each cycle settles the design once and dumps one
+    // sample after the rising edge. The low phase eval is still needed for
+    // Verilator to see the next edge, but nothing is sensitive to it so it
+    // returns straight away. The +both_edges plusarg dumps both phases, for
+    // waveforms that show the clock.
+    uint64_t step(uint64_t budget)
+    {
+        if (kanata_) kanata_->cycle(cycles());
+        // the FIFO pops the word at this edge
+        if (top_->out_valid && top_->out_ready) outputs_.push_back({cycles(), top_->out_data});
+
+        if (both_edges_)
+        {
+            top_->clk = 0;
+            top_->eval();
+            if (tfp_) tfp_->dump(2 * ticks_);
+            top_->clk = 1;
+            top_->eval();
+            if (tfp_) tfp_->dump(2 * ticks_ + 1);
+        }
+        else
+        {
+            {
+                PROFILE_PHASE("eval");
+                top_->clk = 0;
+                top_->eval();
+                top_->clk = 1;
+                top_->eval();
+            }
+            PROFILE_PHASE("trace");
+            if (tfp_) tfp_->dump(2 * ticks_ + 1);
+        }
+        ticks_++;
+
+        if (Verilated::gotFinish())
+        {
+            exit(0);
+        }
+
+        PROFILE_PHASE("loop skip");
+        uint64_t limit = kanata_ ? std::min(budget - 1, kanata_->skippable(cycles())) : budget - 1;
+        uint64_t skipped = skipper_ ? skipper_->trySkip(limit) : 0;
+        ticks_ += skipped;
+        if (telemetry_) telemetry_->sample();
+        return 1 + skipped;
+    }
+
+    // +<name><number> plusarg, fallback when it isn't given
+    uint64_t plusargNumber(const char* name, uint64_t fallback) const
+    {
+        const char* match = context_->commandArgsPlusMatch(name);
+        return match[0] ? strtoull(match + 1 + strlen(name), nullptr, 0) : fallback;
+    }
+
     VerilatedContext* context_;
     Vdut* top_;
-    VerilatedVcdC* tfp_;
+    VerilatedVcdC* tfp_ = nullptr;
     std::string name_;
+    std::string tb_dir_;
+    std::filesystem::path start_dir_;
     unsigned int ticks_;
+    bool both_edges_;
+    bool loop_skip_;
+    std::unique_ptr<LoopSkipper> skipper_;
+    uint64_t kanata_start_;
+    uint64_t kanata_cycles_;
+    std::unique_ptr<KanataLog> kanata_;
+    uint64_t telemetry_interval_;
+    std::string telemetry_file_;
+    std::unique_ptr<Telemetry> telemetry_;
+    std::vector<OutputEvent> outputs_;
+
+    static inline int argc_ = 0;
+    static inline const char** argv_ = nullptr;
 };
@@ -0,0 +1,237 @@
+// Cycle-count regression gate: runs every program/dataset to its halt loop,
+// records cycles-to-halt and retired instructions from the counters in top.sv
+// and compares them with perf_baseline.txt.
+//
+// A workload fails when its CPI is more than the tolerance (default 1%) above
+// the baseline, or when its retired instruction count changed at all (the
+// program or the core's behaviour changed, re-baseline if that was intended).
+//
+// Built against the five stage core (PIPELINED) it gates on
+// perf_baseline_pipelined.txt instead, prints the branch predictor counters of
+// every workload and its CPI against the single cycle baseline. Either core
+// built with an instruction cache (top -GICACHE_BYTES=...) prints its hits,
+// misses and refill stall cycles, and with a data cache (-GDCACHE_BYTES=...)
+// its hit rate, writebacks and stall cycles, and the misses its victim cache
+// saved when it has one, and with MSHRs (-GDCACHE_MSHRS=...) the misses the
+// core went on past and the cycles decode then waited for them. A data
+// prefetcher (-GPREFETCH_SCHEME=...) prints the lines it filled, its accuracy
+// (the share of them a load or store then hit) and coverage (the share of
+// would-be misses it removed). A store buffer (-GSTORE_BUFFER_ENTRIES=...)
+// prints the loads it forwarded and the cycles the core held for it.
+//
+// Usage: perf [--tolerance=<percent>] [--rebaseline] [--csv=<path>] [gtest flags]
+//   --rebaseline  run everything, print a diff against the old baseline and
+//                 overwrite perf_baseline.txt instead of failing
+//   --csv         also write every result with its host time (sweep.sh reads it)
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cpu_testbench.h"
+#include "workloads.h"
+
+#define SINGLE_CYCLE_BASELINE_FILE "/program_tests/perf_baseline.txt"
+#ifdef PIPELINED
+#define PERF_BASELINE_FILE "/program_tests/perf_baseline_pipelined.txt"
+#else
+#define PERF_BASELINE_FILE SINGLE_CYCLE_BASELINE_FILE
+#endif
+
+struct PerfResult
+{
+    uint64_t cycles = 0;
+    uint64_t instret = 0;
+    double seconds = 0; // host time, not part of the baseline
+
+    double cpi() const { return instret ? double(cycles) / instret : 0; }
+};
+
+static double tolerance = 1.0; // percent
+static bool rebaseline = false;
+static std::string csv_path;
+static std::map<std::string, PerfResult> baseline;
+static std::map<std::string, PerfResult> results;
+
+static std::map<std::string, PerfResult> readBaseline(const std::string &path)
+{
+    std::map<std::string, PerfResult> entries;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        PerfResult result;
+        if (fields >> name >> result.cycles >> result.instret) entries[name] = result;
+    }
+    return entries;
+}
+
+static void writeBaseline(const std::string &path, const std::map<std::string, PerfResult> &entries)
+{
+    std::ofstream file(path);
+    file << "# Cycles-to-halt baseline for program_tests/perf.cpp, regenerate with --rebaseline\n";
+    file << "# workload              cycles     instret\n";
+    for (const auto &entry : entries)
+        file << std::left << std::setw(20) << entry.first << std::right << std::setw(10) << entry.second.cycles
+             << std::setw(12) << entry.second.instret << "\n";
+}
+
+static void printDiff(const std::map<std::string, PerfResult> &old_entries,
+                      const std::map<std::string, PerfResult> &new_entries)
+{
+    std::cout << std::left << std::setw(20) << "workload" << std::right << std::setw(12) << "old cycles" << std::setw(12)
+              << "new cycles" << std::setw(9) << "delta" << std::setw(9) << "old CPI" << std::setw(9) << "new CPI"
+              << std::endl;
+    std::cout << std::fixed;
+    for (const auto &entry : new_entries)
+    {
+        std::cout << std::left << std::setw(20) << entry.first << std::right;
+        auto old_it = old_entries.find(entry.first);
+        if (old_it == old_entries.end())
+        {
+            std::cout << std::setw(12) << "-" << std::setw(12) << entry.second.cycles << std::setw(9) << "new"
+                      << std::setw(9) << "-" << std::setw(9) << std::setprecision(3) << entry.second.cpi() << std::endl;
+            continue;
+        }
+        const PerfResult &old_result = old_it->second;
+        double delta = 100.0 * (double(entry.second.cycles) - old_result.cycles) / old_result.cycles;
+        std::cout << std::setw(12) << old_result.cycles << std::setw(12) << entry.second.cycles << std::setw(8)
+                  << std::setprecision(1) << std::showpos << delta << "%" << std::noshowpos << std::setw(9)
+                  << std::setprecision(3) << old_result.cpi() << std::setw(9) << entry.second.cpi() << std::endl;
+    }
+    for (const auto &entry : old_entries)
+    {
+        if (!new_entries.count(entry.first)) std::cout << std::left << std::setw(20) << entry.first << " removed" << std::endl;
+    }
+}
+
+class PerfTestbench : public CpuTestbench, public ::testing::WithParamInterface<Workload>
+{
+};
+
+TEST_P(PerfTestbench, CyclesToHalt)
+{
+    const Workload &workload = GetParam();
+    setupTest(workload.program);
+    if (!workload.data.empty()) setData("reference/" + workload.data + ".mem");
+    initSimulation();
+    if (workload.trigger) top_->trigger = 1;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(runUntilHalt(workload.max_cycles)) << workload.name() << " did not reach its halt loop";
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PerfResult result{cycles(), instret(), seconds};
+    results[workload.name()] = result;
+#ifdef PIPELINED
+    CpuBackdoor backdoor(top_);
+    std::cout << workload.name() << ": " << backdoor.bpLookups() << " branches/jumps, " << backdoor.bpHits()
+              << " predictor hits, " << backdoor.bpMispredicts() << " mispredicts" << std::endl;
+#else
+    CpuBackdoor backdoor(top_);
+#endif
+    if (backdoor.icacheMisses())
+        std::cout << workload.name() << ": " << backdoor.icacheHits() << " icache hits, " << backdoor.icacheMisses()
+                  << " misses, " << backdoor.icacheStalls() << " stall cycles" << std::endl;
+    if (backdoor.dcacheAccesses())
+    {
+        std::cout << workload.name() << ": " << backdoor.dcacheAccesses() << " dcache accesses, " << std::fixed
+                  << std::setprecision(2) << 100.0 * (1.0 - double(backdoor.dcacheMisses()) / backdoor.dcacheAccesses())
+                  << std::defaultfloat << "% hits, " << backdoor.dcacheWritebacks() << " writebacks, "
+                  << backdoor.dcacheStalls() << " stall cycles";
+        if (backdoor.dcacheVictimHits())
+            std::cout << ", " << backdoor.dcacheVictimHits() << " victim cache hits";
+        if (backdoor.dcacheDeferred())
+            std::cout << ", " << backdoor.dcacheDeferred() << " deferred misses, " << backdoor.dcachePendingStalls()
+                      << " cycles waiting on them";
+        std::cout << std::endl;
+    }
+    if (backdoor.prefetches())
+        std::cout << workload.name() << ": " << backdoor.prefetches() << " prefetches, " << std::fixed
+                  << std::setprecision(2) << 100.0 * backdoor.prefetchesUseful() / backdoor.prefetches()
+                  << "% accurate, " << 100.0 * backdoor.prefetchesUseful()
+                  / (backdoor.prefetchesUseful() + backdoor.dcacheMisses())
+                  << std::defaultfloat << "% coverage" << std::endl;
+    if (backdoor.storeBufferForwards() || backdoor.storeBufferStalls())
+        std::cout << workload.name() << ": " << backdoor.storeBufferForwards() << " store buffer forwards, "
+                  << backdoor.storeBufferStalls() << " stall cycles" << std::endl;
+    if (rebaseline) return;
+
+    auto it = baseline.find(workload.name());
+    ASSERT_NE(it, baseline.end()) << workload.name() << " has no baseline, run with --rebaseline";
+    const PerfResult &base = it->second;
+    EXPECT_EQ(result.instret, base.instret) << "retired instruction count changed";
+    EXPECT_LE(result.cpi(), base.cpi() * (1.0 + tolerance / 100.0))
+        << "CPI regressed from " << base.cpi() << " to " << result.cpi() << " (" << base.cycles << " -> "
+        << result.cycles << " cycles, tolerance " << tolerance << "%)";
+    if (result.cpi() < base.cpi() * (1.0 - tolerance / 100.0))
+        std::cout << workload.name() << ": CPI improved from " << base.cpi() << " to " << result.cpi()
+                  << ", consider --rebaseline" << std::endl;
+}
+
+INSTANTIATE_TEST_SUITE_P(Programs, PerfTestbench, ::testing::ValuesIn(allWorkloads()),
+                         [](const ::testing::TestParamInfo<Workload> &info) { return workloadTestName(info.param); });
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    CpuTestbench::setArgs(argc, argv);
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--rebaseline") == 0) rebaseline = true;
+        else if (strncmp(argv[i], "--tolerance=", 12) == 0) tolerance = atof(argv[i] + 12);
+        else if (strncmp(argv[i], "--csv=", 6) == 0) csv_path = std::filesystem::absolute(argv[i] + 6).string();
+    }
+
+    // resolved before the tests change directory
+    std::string baseline_path = std::filesystem::absolute(TB_DIR PERF_BASELINE_FILE).string();
+    baseline = readBaseline(baseline_path);
+
+    auto res = RUN_ALL_TESTS();
+    reportPhases(std::cout);
+
+#ifdef PIPELINED
+    std::cout << "Pipelined against the single cycle core (old = " SINGLE_CYCLE_BASELINE_FILE ")" << std::endl;
+    printDiff(readBaseline(std::filesystem::absolute(TB_DIR SINGLE_CYCLE_BASELINE_FILE).string()), results);
+#endif
+
+    if (!csv_path.empty())
+    {
+        std::ofstream csv(csv_path);
+        csv << "workload,cycles,instret,cpi,seconds\n";
+        for (const auto &entry : results)
+            csv << entry.first << "," << entry.second.cycles << "," << entry.second.instret << ","
+                << entry.second.cpi() << "," << entry.second.seconds << "\n";
+    }
+
+    if (rebaseline)
+    {
+        if (res != 0)
+        {
+            std::cout << "Not re-baselining, some workloads failed" << std::endl;
+            return res;
+        }
+        // keep entries a --gtest_filter skipped, drop workloads that no longer exist
+        std::map<std::string, PerfResult> merged;
+        for (const Workload &workload : allWorkloads())
+        {
+            if (baseline.count(workload.name())) merged[workload.name()] = baseline[workload.name()];
+        }
+        for (const auto &entry : results) merged[entry.first] = entry.second;
+
+        printDiff(baseline, merged);
+        writeBaseline(baseline_path, merged);
+        std::cout << "Wrote " << baseline_path << std::endl;
+    }
+    return res;
+}
@@ -0,0 +1,206 @@
+// First-order energy estimate from switching activity: runs every workload on
+// a model verilated with --coverage-toggle, sums the toggles of the signals
+// declared in each RTL module and weights them by the per-module energy per
+// toggle in energy_coefficients.txt, plus a fixed energy per clock cycle.
+// Reports estimated energy per instruction for each workload and how it
+// splits across regfile, ALU, data_mem, instrmem and controlunit.
+//
+// Toggle counts are exact for the simulated cycles; the coefficients are
+// placeholders until they are calibrated against a gate-level power run, so
+// compare EPI between microarchitecture options rather than reading it as
+// an absolute figure. Loop skipping is off, skipped cycles have no toggles.
+//
+// Usage: power [--coefficients=<path>] [--csv=<path>] [gtest flags]
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../coverage/covmerge.h"
+#include "cpu_testbench.h"
+#include "workloads.h"
+
+#ifndef COVERAGE
+#error "power needs the toggle coverage model, build it with the power CMake target or doit.sh"
+#endif
+
+#define ENERGY_COEFFICIENTS_FILE "/program_tests/energy_coefficients.txt"
+
+// modules reported in their own column, everything else goes into "other"
+static const std::vector<std::string> reported = {"regfile", "ALU", "data_mem", "instrmem", "controlunit"};
+
+struct Coefficients
+{
+    std::map<std::string, double> per_toggle; // pJ per toggle by module
+    double fallback = 0;                      // pJ per toggle for modules not listed
+    double per_cycle = 0;                     // pJ per clock cycle (clock tree, leakage)
+
+    double of(const std::string &module) const
+    {
+        auto it = per_toggle.find(module);
+        return it == per_toggle.end() ? fallback : it->second;
+    }
+};
+
+struct PowerResult
+{
+    uint64_t cycles = 0;
+    uint64_t instret = 0;
+    std::map<std::string, uint64_t> toggles; // by module
+    std::map<std::string, double> energy;    // pJ by report column, including "clock"
+
+    double total() const
+    {
+        double sum = 0;
+        for (const auto &entry : energy) sum += entry.second;
+        return sum;
+    }
+    double epi() const { return instret ? total() / instret : 0; }
+};
+
+static Coefficients coefficients;
+static std::string csv_path;
+static std::map<std::string, PowerResult> results;
+
+static Coefficients readCoefficients(const std::string &path)
+{
+    Coefficients result;
+    std::ifstream file(path);
+    if (!file) std::cerr << "power: could not read " << path << ", every coefficient is 0" << std::endl;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        double value;
+        if (!(fields >> name >> value)) continue;
+        if (name == "cycle") result.per_cycle = value;
+        else if (name == "default") result.fallback = value;
+        else result.per_toggle[name] = value;
+    }
+    return result;
+}
+
+// rtl/<module>.sv holds one module, so the file a point was declared in names it
+static std::string moduleOf(const CoverageDb::Point &point)
+{
+    return std::filesystem::path(point.file).stem().string();
+}
+
+class PowerTestbench : public CpuTestbench, public ::testing::WithParamInterface<Workload>
+{
+};
+
+TEST_P(PowerTestbench, EnergyPerInstruction)
+{
+    const Workload &workload = GetParam();
+    setupTest(workload.program);
+    if (!workload.data.empty()) setData("reference/" + workload.data + ".mem");
+    setLoopSkip(false);
+    initSimulation();
+    if (workload.trigger) top_->trigger = 1;
+    // the reset cycles aren't part of the workload
+    context_->coveragep()->zero();
+    ASSERT_TRUE(runUntilHalt(workload.max_cycles)) << workload.name() << " did not reach its halt loop";
+
+    writeCoverage(context_, "toggles.dat");
+    CoverageDb db;
+    ASSERT_TRUE(db.addFile("toggles.dat")) << "no toggle database, is the model built with --coverage-toggle?";
+
+    PowerResult result;
+    result.cycles = cycles();
+    result.instret = instret();
+    for (const CoverageDb::Point &point : db.points())
+    {
+        if (point.type == "toggle") result.toggles[moduleOf(point)] += point.count;
+    }
+    ASSERT_FALSE(result.toggles.empty()) << "no toggle points in the model";
+
+    for (const std::string &module : reported) result.energy[module] = 0;
+    result.energy["other"] = 0;
+    for (const auto &entry : result.toggles)
+    {
+        bool own_column = std::find(reported.begin(), reported.end(), entry.first) != reported.end();
+        result.energy[own_column ? entry.first : "other"] += entry.second * coefficients.of(entry.first);
+    }
+    result.energy["clock"] = result.cycles * coefficients.per_cycle;
+    results[workload.name()] = result;
+}
+
+INSTANTIATE_TEST_SUITE_P(Programs, PowerTestbench, ::testing::ValuesIn(allWorkloads()),
+                         [](const ::testing::TestParamInfo<Workload> &info) { return workloadTestName(info.param); });
+
+// pJ per instruction by column, then the total
+static void printReport(std::ostream &out)
+{
+    std::vector<std::string> columns = reported;
+    columns.push_back("other");
+    columns.push_back("clock");
+
+    out << "\nestimated energy per instruction (pJ):\n" << std::left << std::setw(16) << "workload" << std::right
+        << std::setw(10) << "instret";
+    for (const std::string &column : columns) out << std::setw(12) << column;
+    out << std::setw(10) << "EPI" << std::setw(14) << "toggles/inst" << "\n";
+
+    out << std::fixed << std::setprecision(2);
+    for (const auto &entry : results)
+    {
+        const PowerResult &result = entry.second;
+        uint64_t toggles = 0;
+        for (const auto &module : result.toggles) toggles += module.second;
+        double per_inst = result.instret ? 1.0 / result.instret : 0;
+
+        out << std::left << std::setw(16) << entry.first << std::right << std::setw(10) << result.instret;
+        for (const std::string &column : columns) out << std::setw(12) << result.energy.at(column) * per_inst;
+        out << std::setw(10) << result.epi() << std::setw(14) << toggles * per_inst << "\n";
+    }
+}
+
+static void writeCsv(const std::string &path)
+{
+    std::ofstream csv(path);
+    csv << "workload,cycles,instret";
+    for (const std::string &module : reported) csv << "," << module << "_pj";
+    csv << ",other_pj,clock_pj,total_pj,epi_pj\n";
+    for (const auto &entry : results)
+    {
+        const PowerResult &result = entry.second;
+        csv << entry.first << "," << result.cycles << "," << result.instret;
+        for (const std::string &column : reported) csv << "," << result.energy.at(column);
+        csv << "," << result.energy.at("other") << "," << result.energy.at("clock") << "," << result.total() << ","
+            << result.epi() << "\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    CpuTestbench::setArgs(argc, argv);
+
+    std::string coefficients_path = std::filesystem::absolute(TB_DIR ENERGY_COEFFICIENTS_FILE).string();
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--coefficients=", 15) == 0)
+            coefficients_path = std::filesystem::absolute(argv[i] + 15).string();
+        else if (strncmp(argv[i], "--csv=", 6) == 0) csv_path = std::filesystem::absolute(argv[i] + 6).string();
+    }
+    coefficients = readCoefficients(coefficients_path);
+
+    auto res = RUN_ALL_TESTS();
+    if (!results.empty())
+    {
+        printReport(std::cout);
+        if (!csv_path.empty()) writeCsv(csv_path);
+    }
+    return res;
+}
@@ -5,6 +5,26 @@
 
 #define CYCLES 10000
 
+// exact counts for 7_delay and the cycles between the words 8_io outputs.
+// 7_delay retires its two setup instructions, three times the outer loop
+// (1000 and 300 turns of the two delay loops and five more instructions) and
+// the last branch before halting. The single cycle core takes one cycle more
+// than that, the five stage one three more to fill and two for each of the 12
+// branches it mispredicts (perf_pipelined prints the count). 8_io pushes a
+// word every three instructions, and the five stage core mispredicts the
+// first taken branch of that loop. With a data or instruction cache the
+// counts depend on its misses, so only the results are checked.
+#define DELAY_INSTRET (2 + 3 * (1 + 2 * 1000 + 1 + 2 * 300 + 3) + 1)
+#ifdef PIPELINED
+#define DELAY_CYCLES (DELAY_INSTRET + 3 + 2 * 12)
+static const uint64_t IO_WORD_CYCLES[] = {3 + 2, 3, 3, 3};
+#else
+#define DELAY_CYCLES (DELAY_INSTRET + 1)
+static const uint64_t IO_WORD_CYCLES[] = {3, 3, 3, 3};
+#endif
+
+static bool exactTiming() { return !CpuBackdoor::hasDcache() && !CpuBackdoor::hasIcache(); }
+
 TEST_F(CpuTestbench, TestAddiBne)
 {
     setupTest("1_addi_bne");
@@ -44,11 +64,130 @@ TEST_F(CpuTestbench, TestPdf)
     initSimulation();
     runSimulation(CYCLES * 100);
     EXPECT_EQ(top_->a0, 15363);
+
+    // every bin is streamed out of the output FIFO as well
+    ASSERT_EQ(outputs().size(), 255);
+    uint32_t sum = 0;
+    for (const OutputEvent &event : outputs()) sum += event.data;
+    EXPECT_EQ(sum, 15363);
+}
+
+// lui reads x0, not the register its immediate bits [19:15] happen to name
+TEST_F(CpuTestbench, TestLui)
+{
+    setupTest("9_lui");
+    initSimulation();
+    runSimulation(CYCLES);
+    EXPECT_EQ(top_->a0, 0x12344000);
+}
+
+// a taken branch redirects while decode waits on a load miss the data cache
+// went on without (DCACHE_MSHRS), the waiting instruction is on the wrong path
+TEST_F(CpuTestbench, TestRedirectPending)
+{
+    setupTest("10_redirect_pending");
+    initSimulation();
+    runSimulation(CYCLES);
+    EXPECT_EQ(top_->a0, 42);
+}
+
+// the delay loops are skipped analytically, counts must match a full run
+// (the pipelined core never skips them, see loop_skip.h)
+TEST_F(CpuTestbench, TestDelay)
+{
+    setupTest("7_delay");
+    initSimulation();
+    ASSERT_TRUE(runUntilHalt(2 * CYCLES));
+    EXPECT_EQ(top_->a0, 3);
+    if (exactTiming())
+    {
+        EXPECT_EQ(cycles(), DELAY_CYCLES);
+    }
+    EXPECT_EQ(instret(), DELAY_INSTRET);
+}
+
+TEST_F(CpuTestbench, TestDelayNoLoopSkip)
+{
+    setupTest("7_delay", "7_delay_no_skip");
+    setLoopSkip(false);
+    initSimulation();
+    ASSERT_TRUE(runUntilHalt(2 * CYCLES));
+    EXPECT_EQ(top_->a0, 3);
+    if (exactTiming())
+    {
+        EXPECT_EQ(cycles(), DELAY_CYCLES);
+    }
+    EXPECT_EQ(instret(), DELAY_INSTRET);
+}
+
+// nothing happens until trigger is pulsed, then the words IO_WORD_CYCLES apart
+TEST_F(CpuTestbench, TestIoTrigger)
+{
+    setupTest("8_io");
+    initSimulation();
+    runSimulation(100);
+    EXPECT_FALSE(halted());
+    EXPECT_TRUE(outputs().empty());
+
+    top_->trigger = 1;
+    runSimulation(1);
+    top_->trigger = 0;
+    ASSERT_TRUE(runUntilHalt(CYCLES));
+
+    ASSERT_EQ(outputs().size(), 5);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(outputs()[i].data, i + 1);
+        if (i && exactTiming())
+        {
+            EXPECT_EQ(outputs()[i].cycle - outputs()[i - 1].cycle, IO_WORD_CYCLES[i - 1]);
+        }
+    }
+    // the harness drained the FIFO as it went
+    EXPECT_EQ(top_->a0, 0);
+}
+
+// with out_ready low the words wait in the FIFO until the harness takes them
+TEST_F(CpuTestbench, TestIoBackpressure)
+{
+    setupTest("8_io", "8_io_backpressure");
+    initSimulation();
+    top_->out_ready = 0;
+    top_->trigger = 1;
+    ASSERT_TRUE(runUntilHalt(CYCLES));
+    EXPECT_EQ(top_->a0, 5);
+    EXPECT_TRUE(outputs().empty());
+
+    top_->out_ready = 1;
+    runSimulation(10);
+    ASSERT_EQ(outputs().size(), 5);
+    for (uint32_t i = 0; i < 5; i++) EXPECT_EQ(outputs()[i].data, i + 1);
+}
+
+// more words than the FIFO holds, the store that finds it full waits in
+// memory until out_ready rises, and no word is lost
+TEST_F(CpuTestbench, TestIoFifoFull)
+{
+    setupTest("11_io_full");
+    initSimulation();
+    top_->out_ready = 0;
+    runSimulation(CYCLES);
+    EXPECT_FALSE(halted());
+    EXPECT_TRUE(outputs().empty());
+
+    top_->out_ready = 1;
+    ASSERT_TRUE(runUntilHalt(CYCLES));
+    EXPECT_EQ(top_->a0, 24);
+    runSimulation(20);
+    ASSERT_EQ(outputs().size(), 24);
+    for (uint32_t i = 0; i < 24; i++) EXPECT_EQ(outputs()[i].data, i + 1);
 }
 
 int main(int argc, char **argv)
 {
+    Verilated::commandArgs(argc, argv);
     testing::InitGoogleTest(&argc, argv);
+    CpuTestbench::setArgs(argc, argv);
     auto res = RUN_ALL_TESTS();
     return res;
 }
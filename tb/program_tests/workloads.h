@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Every program in asm/ that runs to its halt loop, with each dataset it
+// takes. Shared by the cycle-count gate (perf.cpp) and the energy estimate
+// (power.cpp). 6_f1 is left out, it never halts, and so are 9_lui,
+// 10_redirect_pending and 11_io_full, directed tests with nothing to time.
+struct Workload
+{
+    std::string program;
+    std::string data; // empty for programs without a dataset
+    uint64_t max_cycles;
+    bool trigger = false; // hold the trigger input high from the start
+
+    std::string name() const { return data.empty() ? program : program + "." + data; }
+};
+
+inline const std::vector<Workload> &allWorkloads()
+{
+    static const std::vector<Workload> workloads = {
+        {"1_addi_bne", "", 10000},
+        {"2_li_add", "", 10000},
+        {"3_lbu_sb", "", 10000},
+        {"4_jal_ret", "", 10000},
+        {"5_pdf", "gaussian", 1000000},
+        {"5_pdf", "noisy", 1000000},
+        {"5_pdf", "triangle", 1000000},
+        {"5_pdf", "sine", 1000000},
+        {"7_delay", "", 100000},
+        {"8_io", "", 10000, true},
+    };
+    return workloads;
+}
+
+// gtest parameter names can't contain dots
+inline std::string workloadTestName(const Workload &workload)
+{
+    std::string name = workload.name();
+    for (char &c : name)
+        if (c == '.') c = '_';
+    return name;
+}
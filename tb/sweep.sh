@@ -0,0 +1,125 @@
+#!/bin/bash
+
+# Design-space sweep over top-level parameters: builds one perf model per point
+# of the grid (verilator -G), in parallel and through ccache when it's
+# installed, runs the perf workloads on each and prints cycles, CPI, simulated
+# speed, and Fmax, area and MIPS (Fmax / CPI) from synth.sh per variant
+# Usage: ./sweep.sh [-j N] [--filter <gtest filter>] -G NAME=v1,v2,... [-G NAME=...]
+# Example: ./sweep.sh -G DMEM_ADDR_BITS=17,18,20 -G IMEM_ADDR_BITS=12,13
+# Per-workload results go to test_out/sweep/results.csv
+
+# Constants
+SCRIPT_DIR=$(dirname "$(realpath "$0")")
+RTL_FOLDER=$(realpath "$SCRIPT_DIR/../rtl")
+BUILD_DIR="$SCRIPT_DIR/obj_sweep"
+OUT_DIR="$SCRIPT_DIR/test_out/sweep"
+# GoogleTest's library directory, from pkg-config or the compiler's search path unless GTEST_LIB is set
+if [[ -z "$GTEST_LIB" ]]; then
+    GTEST_LIB=$(pkg-config --variable=libdir gtest 2>/dev/null)
+    [[ -n "$GTEST_LIB" ]] || GTEST_LIB=$(dirname "$(g++ -print-file-name=libgtest.a)")
+fi
+GREEN=$(tput setaf 2)
+RED=$(tput setaf 1)
+RESET=$(tput sgr0)
+
+jobs=$(nproc)
+filter="*"
+params=()
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -j) jobs=$2; shift 2 ;;
+        --filter) filter=$2; shift 2 ;;
+        -G) params+=("$2"); shift 2 ;;
+        -G*) params+=("${1#-G}"); shift ;;
+        *) echo "unknown option $1"; exit 2 ;;
+    esac
+done
+if [[ ${#params[@]} -eq 0 ]]; then
+    echo "Usage: ./sweep.sh [-j N] [--filter <gtest filter>] -G NAME=v1,v2,... [-G NAME=...]"
+    exit 2
+fi
+
+cd "$SCRIPT_DIR" || exit
+mkdir -p "$BUILD_DIR" "$OUT_DIR"
+
+# Cartesian product of the grid, one variant per line as NAME=v NAME=v ...
+variants=("")
+for param in "${params[@]}"; do
+    name=${param%%=*}
+    IFS=',' read -ra values <<< "${param#*=}"
+    next=()
+    for variant in "${variants[@]}"; do
+        for value in "${values[@]}"; do
+            next+=("${variant:+$variant }$name=$value")
+        done
+    done
+    variants=("${next[@]}")
+done
+echo "sweep: ${#variants[@]} variants, building $jobs at a time"
+
+# Verilator's makefiles put OBJCACHE in front of every compile, so the runtime
+# and every class a parameter doesn't touch are compiled once for all variants
+objcache=""
+command -v ccache > /dev/null && objcache=ccache
+
+# No --trace: the harness leaves the waveform out of a model without it
+# (VM_TRACE is 0), so the simulated speed doesn't include writing one
+build() {
+    local variant=$1
+    local dir="$BUILD_DIR/${variant// /_}"
+    local gflags=()
+    for assignment in $variant; do gflags+=("-G$assignment"); done
+
+    verilator   -Wall -O3 \
+                -cc "${RTL_FOLDER}/top.sv" \
+                --exe "$SCRIPT_DIR/program_tests/perf.cpp" \
+                -y "$RTL_FOLDER" \
+                --prefix "Vdut" \
+                -o Vperf \
+                --Mdir "$dir" \
+                -Wno-UNUSED \
+                "${gflags[@]}" \
+                -CFLAGS "-std=c++17 -O2" \
+                -LDFLAGS "-L${GTEST_LIB} -lgtest -lpthread" \
+                > "$dir.log" 2>&1 &&
+    make -j2 -C "$dir" -f Vdut.mk OBJCACHE="$objcache" >> "$dir.log" 2>&1 ||
+    echo "${RED}sweep: $variant failed to build, see $dir.log${RESET}"
+}
+export -f build
+export SCRIPT_DIR RTL_FOLDER BUILD_DIR GTEST_LIB RED RESET objcache
+printf '%s\n' "${variants[@]}" | xargs -P "$jobs" -I{} bash -c 'build "$@"' _ {}
+
+# Fmax and area from synth.sh (yosys and OpenSTA), "-" when they're missing.
+# Done before the runs so it doesn't share the CPU with them.
+synth_dir="$OUT_DIR/synth"
+mkdir -p "$synth_dir"
+printf '%s\n' "${variants[@]}" | xargs -P "$jobs" -I{} bash -c \
+    'gflags=(); for a in $1; do gflags+=("-G$a"); done
+     "$0/synth.sh" --summary --out "$2/${1// /_}" "${gflags[@]}" > "$2/${1// /_}.summary"' \
+    "$SCRIPT_DIR" {} "$synth_dir"
+
+# Runs are sequential so the simulated speed isn't shared between variants.
+# Loop skipping is off so every cycle is simulated and the speed is comparable.
+echo "variant,workload,cycles,instret,cpi,seconds" > "$OUT_DIR/results.csv"
+printf "\n%-40s %12s %7s %11s %9s %9s %14s\n" "variant" "cycles" "CPI" "Mcycles/s" "Fmax MHz" "MIPS" "area"
+for variant in "${variants[@]}"; do
+    dir="$BUILD_DIR/${variant// /_}"
+    if [[ ! -x "$dir/Vperf" ]]; then
+        printf "%-40s %12s\n" "$variant" "build failed"
+        continue
+    fi
+    csv="$OUT_DIR/${variant// /_}.csv"
+    "$dir/Vperf" --gtest_filter="$filter" --tolerance=1000 --csv="$csv" +no_loop_skip +telemetry=0 \
+        > "$dir.run.log" 2>&1
+    tail -n +2 "$csv" | sed "s/^/$variant,/" >> "$OUT_DIR/results.csv"
+    read -r fmax area < "$synth_dir/${variant// /_}.summary"
+    awk -F, -v variant="$variant" -v fmax="${fmax:--}" -v area="${area:--}" '
+        NR > 1 { cycles += $2; instret += $3; seconds += $5 }
+        END {
+            cpi = instret ? cycles / instret : 0
+            speed = seconds > 0 ? cycles / seconds / 1e6 : 0
+            mips = (fmax != "-" && cpi > 0) ? sprintf("%.1f", fmax / cpi) : "-"
+            printf "%-40s %12d %7.3f %11.2f %9s %9s %14s\n", variant, cycles, cpi, speed, fmax, mips, area
+        }' "$csv"
+done
+echo "${GREEN}sweep: per-workload results in $OUT_DIR/results.csv${RESET}"
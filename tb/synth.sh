@@ -0,0 +1,201 @@
+#!/bin/bash
+
+# Synthesis and static timing for one configuration of top: yosys maps the
+# core to the generic cell library in synth/generic.lib, with instrmem and
+# data_mem kept as ROM/SRAM macros, and OpenSTA times the mapped netlist.
+# Reports cell area, the critical path and Fmax, and with --cpi the
+# instructions per second that gives
+# Usage: ./synth.sh [-G NAME=VALUE ...] [--cpi CPI] [--out DIR] [--summary]
+# Example: ./synth.sh -G DMEM_ADDR_BITS=18 --cpi 1.0
+# --summary prints only "<Fmax MHz> <area>" for sweep.sh, "-" where a tool is missing
+# Outputs go to test_out/synth/<configuration>/, the report in report.txt
+
+# Constants
+SCRIPT_DIR=$(dirname "$(realpath "$0")")
+RTL_FOLDER=$(realpath "$SCRIPT_DIR/../rtl")
+SYNTH_FOLDER="$SCRIPT_DIR/synth"
+GREEN=$(tput setaf 2)
+RED=$(tput setaf 1)
+RESET=$(tput sgr0)
+
+# Memory macro model. Access time grows with the number of address bits
+# (decoder depth and bitline length), area with the number of bits plus the
+# periphery. Units match generic.lib: ns and NAND2 equivalents.
+MEM_ACCESS_BASE=0.20        # ns
+MEM_ACCESS_PER_ADDR_BIT=0.035
+SRAM_WRITE_SETUP=0.10       # ns, address, data and enable before the write edge
+SRAM_AREA_PER_BIT=0.30
+ROM_AREA_PER_BIT=0.15
+MEM_PERIPHERY=1.15
+# only slack is measured, the period just has to be longer than any path
+STA_PERIOD=100
+
+params=()
+cpi=""
+out_dir=""
+summary=0
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -G) params+=("$2"); shift 2 ;;
+        -G*) params+=("${1#-G}"); shift ;;
+        --cpi) cpi=$2; shift 2 ;;
+        --out) out_dir=$(realpath -m "$2"); shift 2 ;;
+        --summary) summary=1; shift ;;
+        *) echo "unknown option $1"; exit 2 ;;
+    esac
+done
+
+if ! command -v yosys > /dev/null; then
+    [[ $summary -eq 1 ]] && { echo "- -"; exit 0; }
+    echo "${RED}Error: yosys not found${RESET}"
+    exit 1
+fi
+
+variant="${params[*]}"
+name=${variant// /_}
+out_dir=${out_dir:-$SCRIPT_DIR/test_out/synth/${name:-default}}
+mkdir -p "$out_dir"
+
+# Memory depths: the overrides, otherwise the defaults in top.sv
+param() {
+    local name=$1
+    for assignment in "${params[@]}"; do
+        [[ ${assignment%%=*} == "$name" ]] && { echo "${assignment#*=}"; return; }
+    done
+    sed -n "s/.*parameter $name *= *\([0-9]*\).*/\1/p" "$RTL_FOLDER/top.sv" | head -n 1
+}
+imem_bits=$(param IMEM_ADDR_BITS)
+dmem_bits=$(param DMEM_ADDR_BITS)
+
+# Timing and area of the two macros for these depths, both are 2^bits bytes
+# read as 32-bit words
+awk -v imem="$imem_bits" -v dmem="$dmem_bits" -v base="$MEM_ACCESS_BASE" -v per_bit="$MEM_ACCESS_PER_ADDR_BIT" \
+    -v setup="$SRAM_WRITE_SETUP" -v sram="$SRAM_AREA_PER_BIT" -v rom="$ROM_AREA_PER_BIT" -v periphery="$MEM_PERIPHERY" '
+    function arc(pin, type, sense, value) {
+        printf "            timing () {\n                related_pin : \"%s\";\n", pin
+        if (type != "") printf "                timing_type : %s;\n", type
+        if (sense != "") printf "                timing_sense : %s;\n", sense
+        printf "                cell_rise (scalar) { values (\"%.4f\"); }\n", value
+        printf "                cell_fall (scalar) { values (\"%.4f\"); }\n", value
+        printf "                rise_transition (scalar) { values (\"0.0500\"); }\n"
+        printf "                fall_transition (scalar) { values (\"0.0500\"); }\n"
+        printf "            }\n"
+    }
+    function check(value) {
+        printf "            timing () {\n                related_pin : \"clk_i\";\n                timing_type : setup_rising;\n"
+        printf "                rise_constraint (scalar) { values (\"%.4f\"); }\n", value
+        printf "                fall_constraint (scalar) { values (\"%.4f\"); }\n", value
+        printf "            }\n"
+    }
+    function input_bus(name, with_check) {
+        printf "        bus (%s) {\n            bus_type : word;\n            direction : input;\n            capacitance : 0.010;\n", name
+        if (with_check) check(setup)
+        printf "        }\n"
+    }
+    BEGIN {
+        print "/* generated by synth.sh for IMEM_ADDR_BITS=" imem " DMEM_ADDR_BITS=" dmem " */"
+        print "library (riskv_macros) {"
+        print "    delay_model : table_lookup;"
+        print "    time_unit : \"1ns\";"
+        print "    voltage_unit : \"1V\";"
+        print "    current_unit : \"1mA\";"
+        print "    capacitive_load_unit (1, pf);"
+        print "    pulling_resistance_unit : \"1kohm\";"
+        print "    nom_process : 1;"
+        print "    nom_voltage : 1.0;"
+        print "    nom_temperature : 25;"
+        print "    type (word) {\n        base_type : array;\n        data_type : bit;\n        bit_width : 32;"
+        print "        bit_from : 31;\n        bit_to : 0;\n        downto : true;\n    }"
+
+        print "    cell (instrmem) {"
+        printf "        area : %.2f;\n", 2 ^ imem * 8 * rom * periphery
+        input_bus("addr_i", 0)
+        print "        bus (read_data_o) {\n            bus_type : word;\n            direction : output;"
+        arc("addr_i", "", "non_unate", base + per_bit * imem)
+        print "        }\n    }"
+
+        print "    cell (data_mem) {"
+        printf "        area : %.2f;\n", 2 ^ dmem * 8 * sram * periphery
+        print "        pin (clk_i) {\n            direction : input;\n            clock : true;\n            capacitance : 0.010;\n        }"
+        print "        pin (write_en_i) {\n            direction : input;\n            capacitance : 0.010;"
+        check(setup)
+        print "        }"
+        input_bus("addr_i", 1)
+        input_bus("write_data_i", 1)
+        print "        bus (read_data_o) {\n            bus_type : word;\n            direction : output;"
+        arc("addr_i", "", "non_unate", base + per_bit * dmem)
+        # a write to the word being read shows on the next edge
+        arc("clk_i", "rising_edge", "", base + per_bit * dmem)
+        print "        }\n    }"
+        print "}"
+    }' > "$out_dir/macros.lib"
+
+# Everything but the memories, the sparse DPI model and the coverage-only
+# cover points
+sources=()
+for file in "$RTL_FOLDER"/*.sv; do
+    case $(basename "$file") in
+        instrmem.sv|data_mem.sv|data_mem_sparse.sv|coverpoints.sv) ;;
+        *) sources+=("$file") ;;
+    esac
+done
+chparams=""
+for assignment in "${params[@]}"; do chparams+="chparam -set ${assignment%%=*} ${assignment#*=} top; "; done
+
+# The performance counters and probes have no fanout and are removed
+if ! yosys -q -l "$out_dir/yosys.log" -p "read_verilog -sv -I$RTL_FOLDER ${sources[*]}; \
+        read_verilog -lib $SYNTH_FOLDER/macros.v; ${chparams} \
+        hierarchy -check -top top; synth -top top -flatten; \
+        setparam -unset ADDR_WIDTH -unset DATA_WIDTH -unset MEM_ADDR_BITS t:instrmem t:data_mem; \
+        dfflibmap -liberty $SYNTH_FOLDER/generic.lib; abc -liberty $SYNTH_FOLDER/generic.lib; opt_clean; \
+        tee -o $out_dir/stat.txt stat -liberty $SYNTH_FOLDER/generic.lib; \
+        write_verilog -noattr -noexpr $out_dir/netlist.v" > /dev/null 2>&1; then
+    [[ $summary -eq 1 ]] && { echo "- -"; exit 0; }
+    echo "${RED}Error: synthesis failed, see $out_dir/yosys.log${RESET}"
+    exit 1
+fi
+
+cells=$(awk '/Number of cells:/ { cells = $4 } END { print cells }' "$out_dir/stat.txt")
+logic_area=$(awk '/Chip area for/ { area = $NF } END { printf "%.2f", area }' "$out_dir/stat.txt")
+mem_area=$(awk '/^ *area :/ { sum += $3 } END { printf "%.2f", sum }' "$out_dir/macros.lib")
+area=$(awk -v a="$logic_area" -v b="$mem_area" 'BEGIN { printf "%.2f", a + b }')
+
+critical="-"
+fmax="-"
+if command -v sta > /dev/null; then
+    SYNTH_LIBS="$SYNTH_FOLDER/generic.lib $out_dir/macros.lib" SYNTH_NETLIST="$out_dir/netlist.v" \
+        SYNTH_PERIOD=$STA_PERIOD sta -no_init -exit "$SYNTH_FOLDER/sta.tcl" > "$out_dir/sta.log" 2>&1
+    critical=$(awk '/^critical path/ { print $3 }' "$out_dir/sta.log")
+    if [[ -n "$critical" ]]; then
+        fmax=$(awk -v ns="$critical" 'BEGIN { printf "%.1f", 1000 / ns }')
+    else
+        critical="-"
+        echo "${RED}Warning: timing failed, see $out_dir/sta.log${RESET}" >&2
+    fi
+fi
+
+if [[ $summary -eq 1 ]]; then
+    echo "$fmax $area"
+    exit 0
+fi
+
+{
+    echo "configuration:   ${variant:-defaults} (IMEM_ADDR_BITS=$imem_bits DMEM_ADDR_BITS=$dmem_bits)"
+    echo "cells:           $cells"
+    echo "area:            $area NAND2 eq ($logic_area logic, $mem_area memory macros)"
+    echo "critical path:   $critical ns"
+    echo "Fmax:            $fmax MHz"
+    if [[ -n "$cpi" && "$fmax" != "-" ]]; then
+        awk -v fmax="$fmax" -v cpi="$cpi" 'BEGIN { printf "MIPS:            %.1f at CPI %s\n", fmax / cpi, cpi }'
+    fi
+    if [[ -f "$out_dir/sta.log" ]]; then
+        echo
+        sed '/^critical path/d' "$out_dir/sta.log"
+    fi
+} > "$out_dir/report.txt"
+
+cat "$out_dir/report.txt"
+if ! command -v sta > /dev/null; then
+    echo "${RED}OpenSTA (sta) not found, area only${RESET}"
+fi
+echo "${GREEN}synth: outputs in $out_dir${RESET}"
@@ -0,0 +1,31 @@
+// Black-box stand-ins for the two memories, read by synth.sh in place of
+// rtl/instrmem.sv and rtl/data_mem.sv. Flattened into flops they would take
+// hours to synthesize and be timed as a huge register file, where a real
+// core uses ROM/SRAM macros. synth.sh writes a timing and area model for
+// each one, sized from the configuration, next to the netlist (macros.lib).
+// Ports and parameters match the RTL modules.
+
+(* blackbox *)
+module instrmem #(
+    parameter ADDR_WIDTH = 32,
+    parameter DATA_WIDTH = 8,
+    parameter MEM_ADDR_BITS = 12
+) (
+    input  [ADDR_WIDTH-1:0] addr_i,
+    output [ADDR_WIDTH-1:0] read_data_o
+);
+endmodule
+
+(* blackbox *)
+module data_mem #(
+    parameter ADDR_WIDTH = 32,
+    parameter DATA_WIDTH = 8,
+    parameter MEM_ADDR_BITS = 17
+) (
+    input                   clk_i,
+    input                   write_en_i,
+    input  [ADDR_WIDTH-1:0] addr_i,
+    input  [ADDR_WIDTH-1:0] write_data_i,
+    output [ADDR_WIDTH-1:0] read_data_o
+);
+endmodule
@@ -0,0 +1,22 @@
+# OpenSTA script for tb/synth.sh, paths come in through the environment:
+#   SYNTH_LIBS     liberty files, space separated
+#   SYNTH_NETLIST  mapped netlist from yosys
+#   SYNTH_PERIOD   clock period in ns, only used to measure slack against
+# Prints the worst register-to-register path and "critical path <ns>".
+
+foreach lib $::env(SYNTH_LIBS) {
+    read_liberty $lib
+}
+read_verilog $::env(SYNTH_NETLIST)
+link_design top
+
+set period $::env(SYNTH_PERIOD)
+create_clock -name clk -period $period [get_ports clk]
+# rst is asynchronous, and paths to and from the other ports depend on
+# whatever the core is connected to, so only reg-to-reg paths are timed
+set_false_path -from [get_ports rst]
+
+report_checks -path_delay max -group_count 1 -fields {fanout} -digits 3
+set slack [sta::worst_slack -max]
+puts [format "critical path %.3f" [expr {$period - $slack}]]
+exit
@@ -6,6 +6,8 @@
 #include "verilated_vcd_c.h"
 #include "gtest/gtest.h"
 
+#include "../common/coverage.h"
+
 #define MAX_SIM_CYCLES 10000
 
 class BaseTestbench : public ::testing::Test
@@ -26,6 +28,11 @@ public:
 
     void TearDown() override{
         top->final();
+
+        // one coverage database per test (coverage build only)
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        writeCoverage(Verilated::threadContextp(),
+                      std::string("test_out/coverage/") + info->test_suite_name() + "." + info->name() + ".dat", true);
         #ifndef __APPLE__
                 if (tfp) {
                     tfp->close();
@@ -0,0 +1,171 @@
+#include "base_testbench.h"
+#include "../common/sparse_mem.h"
+
+class DataMemSparseTestbench : public BaseTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk_i = 0;
+        top->read_en_i = 0;
+        top->write_en_i = 0;
+        top->addr_i = 0;
+        top->write_data_i = 0;
+
+        //run the initial block (which preloads data.hex if present) then start empty
+        top->eval();
+        sparseMem().clear();
+    }
+
+    void stepClock()
+    {
+        top->clk_i = 1;
+        tick();
+
+        top->clk_i = 0;
+        tick();
+    }
+};
+
+TEST_F(DataMemSparseTestbench, BasicWriteRead)
+{
+    top->write_en_i = 1;
+    top->addr_i = 0x00000100;
+    top->write_data_i = 0xDEADBEEF;
+    stepClock();
+
+    top->write_en_i = 0;
+    tick();
+
+    EXPECT_EQ(top->read_data_o, 0xDEADBEEF);
+}
+
+//the dense data_mem aliases on addr[16:0], the sparse one must not
+TEST_F(DataMemSparseTestbench, NoAddressAliasing)
+{
+    top->write_en_i = 1;
+    top->addr_i = 0x00001000;
+    top->write_data_i = 0xCAFEBABE;
+    stepClock();
+
+    top->addr_i = 0x80001000;
+    top->write_data_i = 0x12345678;
+    stepClock();
+
+    top->write_en_i = 0;
+    top->addr_i = 0x00001000;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0xCAFEBABE);
+
+    top->addr_i = 0x00021000;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0);
+
+    top->addr_i = 0x80001000;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0x12345678);
+}
+
+//rewriting the same address must show up without the address changing
+TEST_F(DataMemSparseTestbench, OverwriteSameAddress)
+{
+    top->write_en_i = 1;
+    top->addr_i = 0x200;
+    top->write_data_i = 0xAAAAAAAA;
+    stepClock();
+    EXPECT_EQ(top->read_data_o, 0xAAAAAAAA);
+
+    top->write_data_i = 0x55555555;
+    stepClock();
+    EXPECT_EQ(top->read_data_o, 0x55555555);
+}
+
+//pages are only allocated on write, unmapped reads return 0
+TEST_F(DataMemSparseTestbench, PagesAllocatedOnWrite)
+{
+    top->addr_i = 0xFFFF0000;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0);
+    EXPECT_EQ(sparseMem().pageCount(), 0u);
+
+    top->write_en_i = 1;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        top->addr_i = i * 0x01000000;
+        top->write_data_i = i;
+        stepClock();
+    }
+    EXPECT_EQ(sparseMem().pageCount(), 4u);
+
+    auto stats = sparseMem().pageStats();
+    EXPECT_EQ(stats[0x03000000].writes, 1u);
+}
+
+//a read counts once per clock edge it's enabled on, however often the model evaluates
+TEST_F(DataMemSparseTestbench, ReadsCountedPerAccess)
+{
+    top->write_en_i = 1;
+    top->addr_i = 0x300;
+    top->write_data_i = 0x600DF00D;
+    stepClock();
+
+    top->write_en_i = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        top->addr_i = 0x300 + 4 * (i & 1);
+        tick();
+    }
+    EXPECT_EQ(sparseMem().pageStats()[0].reads, 0u);
+
+    top->read_en_i = 1;
+    top->addr_i = 0x300;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0x600DF00Du);
+    stepClock();
+    stepClock();
+    EXPECT_EQ(sparseMem().pageStats()[0].reads, 2u);
+    EXPECT_EQ(sparseMem().pageStats()[0].writes, 1u);
+
+    top->addr_i = 0x40000000;
+    stepClock();
+    EXPECT_EQ(sparseMem().unmappedReads(), 1u);
+}
+
+//backdoor loads and dumps from the harness side are visible to the RTL
+TEST_F(DataMemSparseTestbench, BackdoorLoadDump)
+{
+    const uint8_t bytes[] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+    sparseMem().loadBytes(0x00400000, bytes, sizeof(bytes));
+
+    top->addr_i = 0x00400004;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0x88776655);
+
+    ASSERT_TRUE(sparseMem().dumpHex("sparse_dump.hex", 0x00400000, sizeof(bytes)));
+
+    SparseMem copy;
+    EXPECT_EQ(copy.loadHex("sparse_dump.hex", 0x10000), long(sizeof(bytes)));
+    EXPECT_EQ(copy.read32(0x10000), 0x44332211u);
+    std::remove("sparse_dump.hex");
+}
+
+//unaligned access straddling two pages
+TEST_F(DataMemSparseTestbench, PageStraddle)
+{
+    top->write_en_i = 1;
+    top->addr_i = 0x00000FFE;
+    top->write_data_i = 0xA1B2C3D4;
+    stepClock();
+
+    top->write_en_i = 0;
+    tick();
+    EXPECT_EQ(top->read_data_o, 0xA1B2C3D4);
+    EXPECT_EQ(sparseMem().read8(0x1000), 0xB2);
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
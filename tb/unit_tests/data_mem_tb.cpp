@@ -9,14 +9,17 @@ protected:
         top->write_en_i = 0;
         top->addr_i = 0;
         top->write_data_i = 0;
+        // Verilator takes the clock's previous value from the first eval,
+        // so settle the low phase once or the first rising edge is missed
+        tick();
     }
     void stepClock()
     {
-        // Rising edge (setup)
+        // Rising edge (write trigger)
         top->clk_i = 1;
         tick(); 
         
-        // Falling edge (write trigger)
+        // Falling edge
         top->clk_i = 0;
         tick(); 
     }
@@ -28,7 +31,7 @@ TEST_F(DataMemTestbench, BasicWriteRead)
     top->addr_i = 0x00000100;      // Arbitrary address
     top->write_data_i = 0xDEADBEEF; // Test pattern
 
-    // 2. Clock it to commit write (negedge)
+    // 2. Clock it to commit write (posedge)
     stepClock();
 
     // 3. Disable Write
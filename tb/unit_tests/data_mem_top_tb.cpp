@@ -6,20 +6,23 @@ protected:
     void initializeInputs() override
     {
         top->clk_i = 0;
+        top->read_en_i = 0;
         top->write_en_i = 0;
         top->addr_i = 0;
         top->write_data_i = 0;
         top->mem_type_i = 0; // default to word
         top->mem_sign_i = 0; // default to signed
+        // low phase first, the first rising edge is only seen against an earlier eval
+        tick();
     }
 
     void stepClock()
     {
-        // rising edge
+        // rising edge - this is when the write happens in memory
         top->clk_i = 1;
         tick(); 
         
-        // falling edge - this is usually when the write happens in memory
+        // falling edge
         top->clk_i = 0;
         tick(); 
     }
@@ -0,0 +1,206 @@
+#include "memory_port_testbench.h"
+
+//V_dcache_mshr is the default dcache with two MSHRs
+static const uint32_t MSHRS = 2;
+static const uint32_t LINE_BYTES = 16;
+static const uint32_t MEM_LATENCY = 4;
+static const uint32_t REFILL_CYCLES = MEM_LATENCY + LINE_BYTES / 4;
+static const uint32_t MISS_CYCLES = REFILL_CYCLES + 1;
+
+class DcacheMshrTestbench : public MemoryPortTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk = 0;
+        top->read_en_i = 0;
+        top->write_en_i = 0;
+        top->mem_type_i = 0;
+        top->mem_sign_i = 0;
+        top->addr_i = 0;
+        top->write_data_i = 0;
+        top->prefetch_i = 0;
+        top->prefetch_addr_i = 0;
+        top->dest_i = 0;
+        top->cancel_i = 0;
+        top->cancel_dest_i = 0;
+        top->return_ack_i = 0;
+        top->mem_read_data_i = 0;
+        reset();
+    }
+
+    uint32_t memoryRead() const override { return memoryWord(top->mem_addr_o); }
+    MemoryWrite memoryWrite() const override
+    {
+        return {bool(top->mem_write_o), top->mem_addr_o, top->mem_write_data_o};
+    }
+
+    void completing() override { last_defer = top->defer_o; }
+
+    //a load or store on behalf of register dest, a load that misses returns its data there later
+    uint32_t access(bool write, uint32_t addr, uint32_t data = 0, uint8_t dest = 0)
+    {
+        top->dest_i = dest;
+        return MemoryPortTestbench::access(write, addr, data);
+    }
+
+    //a load that misses, true when it went on without its data
+    bool defer(uint32_t addr, uint8_t dest)
+    {
+        return access(false, addr, 0, dest) == 0 && last_defer;
+    }
+
+    //clocks until a deferred load returns and takes it, returns how many cycles that was
+    uint32_t takeReturn()
+    {
+        uint32_t cycles = 0;
+        while (!top->return_o && cycles < MAX_SIM_CYCLES)
+        {
+            stepClock();
+            cycles++;
+        }
+        last_dest = top->return_dest_o;
+        last_return = top->return_data_o;
+        top->return_ack_i = 1;
+        stepClock();
+        top->return_ack_i = 0;
+        settle();
+        return cycles;
+    }
+
+    bool pending(uint8_t dest) const { return (top->pending_o >> dest) & 1; }
+
+    bool last_defer = false;
+    uint8_t last_dest = 0;
+    uint32_t last_return = 0;
+};
+
+TEST_F(DcacheMshrTestbench, LoadMissGoesOn)
+{
+    top->read_en_i = 1;
+    top->addr_i = BASE + 4;
+    top->dest_i = 5;
+    settle();
+    EXPECT_TRUE(top->miss_o);
+    EXPECT_TRUE(top->defer_o);
+    EXPECT_FALSE(top->stall_o);
+
+    EXPECT_TRUE(defer(BASE + 4, 5));
+    EXPECT_TRUE(pending(5));
+    EXPECT_TRUE(top->outstanding_o);
+    EXPECT_LE(takeReturn(), REFILL_CYCLES);
+    EXPECT_EQ(last_dest, 5);
+    EXPECT_EQ(last_return, memoryWord(BASE + 4));
+    EXPECT_FALSE(pending(5));
+    EXPECT_FALSE(top->outstanding_o);
+    //the refill is still going, the word is already in the line being filled
+    EXPECT_EQ(access(false, BASE + 4), 0u);
+    EXPECT_FALSE(last_defer);
+    EXPECT_EQ(last_read, memoryWord(BASE + 4));
+}
+
+TEST_F(DcacheMshrTestbench, HitUnderMiss)
+{
+    EXPECT_TRUE(defer(BASE, 5));
+    takeReturn();
+    //the last word of the line hasn't gone past yet, it is deferred too and returns at the end of the refill
+    EXPECT_TRUE(defer(BASE + LINE_BYTES - 4, 7));
+    takeReturn();
+    EXPECT_EQ(last_dest, 7);
+    EXPECT_EQ(last_return, memoryWord(BASE + LINE_BYTES - 4));
+    EXPECT_TRUE(defer(BASE + LINE_BYTES, 6));
+    EXPECT_EQ(access(true, BASE, 0xFEEDF00D), 0u);
+    EXPECT_EQ(access(false, BASE), 0u);
+    EXPECT_EQ(last_read, 0xFEEDF00Du);
+    EXPECT_TRUE(pending(6));
+    takeReturn();
+    EXPECT_EQ(last_dest, 6);
+    EXPECT_EQ(last_return, memoryWord(BASE + LINE_BYTES));
+}
+
+//the second load waits on the refill the first started, both words are kept as they go past
+TEST_F(DcacheMshrTestbench, SecondaryMissMerges)
+{
+    EXPECT_TRUE(defer(BASE + 8, 5));
+    EXPECT_TRUE(defer(BASE + 12, 6));
+    EXPECT_LE(takeReturn(), REFILL_CYCLES);
+    EXPECT_EQ(last_dest, 5);
+    EXPECT_EQ(last_return, memoryWord(BASE + 8));
+    EXPECT_EQ(takeReturn(), 0u);
+    EXPECT_EQ(last_dest, 6);
+    EXPECT_EQ(last_return, memoryWord(BASE + 12));
+}
+
+//a miss to another line during a refill waits for its own, after the first
+TEST_F(DcacheMshrTestbench, MissUnderMissQueued)
+{
+    EXPECT_TRUE(defer(BASE, 5));
+    EXPECT_TRUE(defer(BASE + 4 * LINE_BYTES, 6));
+    takeReturn();
+    EXPECT_EQ(last_dest, 5);
+    EXPECT_TRUE(pending(6));
+    EXPECT_GE(takeReturn(), MEM_LATENCY);
+    EXPECT_EQ(last_dest, 6);
+    EXPECT_EQ(last_return, memoryWord(BASE + 4 * LINE_BYTES));
+}
+
+//with every MSHR taken a load miss holds the core like a blocking cache, and so does a store miss
+TEST_F(DcacheMshrTestbench, FullMshrsBlock)
+{
+    for (uint32_t i = 0; i < MSHRS; i++)
+        EXPECT_TRUE(defer(BASE + 4 * LINE_BYTES * i, 5 + i));
+    top->read_en_i = 1;
+    top->addr_i = BASE + 4 * LINE_BYTES * MSHRS;
+    settle();
+    EXPECT_TRUE(top->stall_o);
+    EXPECT_FALSE(top->defer_o);
+    top->read_en_i = 0;
+    settle();
+
+    top->return_ack_i = 1;
+    for (uint32_t i = 0; top->outstanding_o && i < MAX_SIM_CYCLES; i++)
+        stepClock();
+    top->return_ack_i = 0;
+    //the last load returned with the first word of its line, the rest of the refill still holds a store miss
+    for (uint32_t i = 0; i < REFILL_CYCLES; i++)
+        stepClock();
+    EXPECT_EQ(access(true, BASE + 0x800, 0x1234), MISS_CYCLES);
+}
+
+//a younger write of the destination, or a younger deferred load to it, drops the older load
+TEST_F(DcacheMshrTestbench, YoungerWriteDropsLoad)
+{
+    EXPECT_TRUE(defer(BASE, 5));
+    top->cancel_i = 1;
+    top->cancel_dest_i = 5;
+    stepClock();
+    top->cancel_i = 0;
+    settle();
+    EXPECT_FALSE(pending(5));
+    EXPECT_FALSE(top->outstanding_o);
+
+    EXPECT_TRUE(defer(BASE + 4 * LINE_BYTES, 6));
+    EXPECT_TRUE(defer(BASE + 8 * LINE_BYTES, 6));
+    takeReturn();
+    EXPECT_EQ(last_return, memoryWord(BASE + 8 * LINE_BYTES));
+    EXPECT_FALSE(top->outstanding_o);
+}
+
+//the data stays until the register file takes it
+TEST_F(DcacheMshrTestbench, ReturnWaitsForAck)
+{
+    EXPECT_TRUE(defer(BASE + 4, 5));
+    for (uint32_t i = 0; i < 2 * REFILL_CYCLES; i++)
+        stepClock();
+    EXPECT_TRUE(top->return_o);
+    EXPECT_EQ(top->return_data_o, memoryWord(BASE + 4));
+    EXPECT_EQ(takeReturn(), 0u);
+    EXPECT_FALSE(top->return_o);
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
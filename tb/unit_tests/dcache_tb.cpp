@@ -0,0 +1,164 @@
+#include "memory_port_testbench.h"
+
+//geometry and latency of the default dcache parameters
+static const uint32_t CACHE_BYTES = 1024;
+static const uint32_t LINE_BYTES = 16;
+static const uint32_t WAYS = 2;
+static const uint32_t MEM_LATENCY = 4;
+static const uint32_t REFILL_CYCLES = MEM_LATENCY + LINE_BYTES / 4;
+static const uint32_t MISS_CYCLES = REFILL_CYCLES + 1;
+static const uint32_t WRITEBACK_MISS_CYCLES = 2 * REFILL_CYCLES + 1;
+//addresses this far apart fall in the same set
+static const uint32_t SET_STRIDE = CACHE_BYTES / WAYS;
+
+class DcacheTestbench : public MemoryPortTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk = 0;
+        top->read_en_i = 0;
+        top->write_en_i = 0;
+        top->mem_type_i = 0;
+        top->mem_sign_i = 0;
+        top->addr_i = 0;
+        top->write_data_i = 0;
+        top->prefetch_i = 0;
+        top->prefetch_addr_i = 0;
+        top->mem_read_data_i = 0;
+        reset();
+    }
+
+    //the cache reads and writes whole words
+    uint32_t memoryRead() const override { return memoryWord(top->mem_addr_o); }
+    MemoryWrite memoryWrite() const override
+    {
+        return {bool(top->mem_write_o), top->mem_addr_o, top->mem_write_data_o};
+    }
+
+    //a prefetch request in a cycle without an access, returns whether the cache started filling the line
+    bool prefetch(uint32_t addr)
+    {
+        top->prefetch_i = 1;
+        top->prefetch_addr_i = addr;
+        settle();
+        EXPECT_TRUE(top->prefetch_ack_o);
+        bool started = top->prefetch_o;
+        stepClock();
+        top->prefetch_i = 0;
+        settle();
+        return started;
+    }
+};
+
+TEST_F(DcacheTestbench, ReadMissRefillsLine)
+{
+    top->read_en_i = 1;
+    top->addr_i = BASE;
+    settle();
+    EXPECT_TRUE(top->stall_o);
+    EXPECT_TRUE(top->miss_o);
+    EXPECT_FALSE(top->writeback_o);
+
+    EXPECT_EQ(access(false, BASE), MISS_CYCLES);
+    EXPECT_EQ(last_read, memoryWord(BASE));
+    for (uint32_t offset = 4; offset < LINE_BYTES; offset += 4)
+    {
+        EXPECT_EQ(access(false, BASE + offset), 0u);
+        EXPECT_EQ(last_read, memoryWord(BASE + offset));
+    }
+}
+
+//a store allocates the line and stays in the cache, the memory keeps the old word
+TEST_F(DcacheTestbench, StoreIsWrittenBack)
+{
+    EXPECT_EQ(access(true, BASE, 0xDEADBEEF), MISS_CYCLES);
+    EXPECT_EQ(load(BASE), 0xDEADBEEFu);
+    EXPECT_EQ(memoryWord(BASE), BASE ^ 0x5A5A0000);
+}
+
+TEST_F(DcacheTestbench, ByteAndHalfwordStores)
+{
+    access(true, BASE, 0x11223344);
+    access(true, BASE + 1, 0xAB, 1);
+    access(true, BASE + 2, 0xCDEF, 2);
+    EXPECT_EQ(load(BASE), 0xCDEFAB44u);
+
+    //lb/lh sign extend, lbu/lhu don't
+    EXPECT_EQ(load(BASE + 1, 1, 0), 0xFFFFFFABu);
+    EXPECT_EQ(load(BASE + 1, 1, 1), 0xABu);
+    EXPECT_EQ(load(BASE + 2, 2, 0), 0xFFFFCDEFu);
+    EXPECT_EQ(load(BASE + 2, 2, 1), 0xCDEFu);
+}
+
+TEST_F(DcacheTestbench, DirtyVictimWrittenBack)
+{
+    access(true, BASE, 0xCAFEF00D);
+    access(false, BASE + SET_STRIDE);
+    //the set is full and the dirty line is the least recently used
+    top->read_en_i = 1;
+    top->addr_i = BASE + 2 * SET_STRIDE;
+    settle();
+    EXPECT_TRUE(top->writeback_o);
+    EXPECT_EQ(access(false, BASE + 2 * SET_STRIDE), WRITEBACK_MISS_CYCLES);
+    EXPECT_EQ(memoryWord(BASE), 0xCAFEF00Du);
+    EXPECT_EQ(load(BASE), 0xCAFEF00Du);
+}
+
+TEST_F(DcacheTestbench, LeastRecentlyUsedReplaced)
+{
+    access(false, BASE);
+    access(false, BASE + SET_STRIDE);
+    access(false, BASE);
+    //evicts BASE + SET_STRIDE, the clean line used longest ago
+    EXPECT_EQ(access(false, BASE + 2 * SET_STRIDE), MISS_CYCLES);
+    EXPECT_EQ(access(false, BASE), 0u);
+    EXPECT_EQ(access(false, BASE + SET_STRIDE), MISS_CYCLES);
+}
+
+TEST_F(DcacheTestbench, PrefetchFillsLine)
+{
+    EXPECT_TRUE(prefetch(BASE));
+    for (uint32_t i = 0; i < REFILL_CYCLES; i++)
+        stepClock();
+    top->read_en_i = 1;
+    top->addr_i = BASE + 4;
+    settle();
+    EXPECT_FALSE(top->stall_o);
+    EXPECT_TRUE(top->prefetch_hit_o);
+    EXPECT_EQ(access(false, BASE + 4), 0u);
+    EXPECT_EQ(last_read, memoryWord(BASE + 4));
+
+    //only the first hit counts
+    top->read_en_i = 1;
+    settle();
+    EXPECT_FALSE(top->prefetch_hit_o);
+}
+
+//loads and stores that hit go on during the fill, a load from the line being filled waits for its word
+TEST_F(DcacheTestbench, HitsGoOnDuringPrefetch)
+{
+    access(false, BASE);
+    EXPECT_TRUE(prefetch(BASE + LINE_BYTES));
+    EXPECT_EQ(access(true, BASE, 0x600DF00D), 0u);
+    EXPECT_EQ(access(false, BASE + LINE_BYTES + 4), MEM_LATENCY + 1);
+    EXPECT_EQ(last_read, memoryWord(BASE + LINE_BYTES + 4));
+    EXPECT_EQ(access(false, BASE + LINE_BYTES), 0u);
+    EXPECT_EQ(last_read, memoryWord(BASE + LINE_BYTES));
+    EXPECT_EQ(load(BASE), 0x600DF00Du);
+}
+
+//a request for a line the cache has is acked and dropped
+TEST_F(DcacheTestbench, PrefetchOfCachedLineDropped)
+{
+    access(false, BASE);
+    EXPECT_FALSE(prefetch(BASE + 4));
+    EXPECT_EQ(access(false, BASE + SET_STRIDE), MISS_CYCLES);
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,129 @@
+#include "memory_port_testbench.h"
+
+//geometry and latency of V_dcache_victim, a direct mapped dcache with a four line victim cache
+static const uint32_t CACHE_BYTES = 1024;
+static const uint32_t LINE_BYTES = 16;
+static const uint32_t VICTIM_ENTRIES = 4;
+static const uint32_t MEM_LATENCY = 4;
+static const uint32_t REFILL_CYCLES = MEM_LATENCY + LINE_BYTES / 4;
+static const uint32_t MISS_CYCLES = REFILL_CYCLES + 1;
+static const uint32_t WRITEBACK_MISS_CYCLES = 2 * REFILL_CYCLES + 1;
+//a hit in the victim cache swaps the lines in one cycle
+static const uint32_t SWAP_CYCLES = 1;
+
+class DcacheVictimTestbench : public MemoryPortTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk = 0;
+        top->read_en_i = 0;
+        top->write_en_i = 0;
+        top->mem_type_i = 0;
+        top->mem_sign_i = 0;
+        top->addr_i = 0;
+        top->write_data_i = 0;
+        top->prefetch_i = 0;
+        top->prefetch_addr_i = 0;
+        top->mem_read_data_i = 0;
+        reset();
+    }
+
+    uint32_t memoryRead() const override { return memoryWord(top->mem_addr_o); }
+    MemoryWrite memoryWrite() const override
+    {
+        return {bool(top->mem_write_o), top->mem_addr_o, top->mem_write_data_o};
+    }
+};
+
+//the second line of a set pushes the first to the victim cache, and they swap back and forth
+TEST_F(DcacheVictimTestbench, ConflictHitsVictimCache)
+{
+    load(BASE);
+    EXPECT_EQ(access(false, BASE + CACHE_BYTES), MISS_CYCLES);
+
+    top->read_en_i = 1;
+    top->addr_i = BASE + 4;
+    settle();
+    EXPECT_TRUE(top->victim_hit_o);
+    EXPECT_FALSE(top->miss_o);
+
+    EXPECT_EQ(access(false, BASE + 4), SWAP_CYCLES);
+    EXPECT_EQ(last_read, memoryWord(BASE + 4));
+    EXPECT_EQ(access(false, BASE), 0u);
+    EXPECT_EQ(access(false, BASE + CACHE_BYTES + 8), SWAP_CYCLES);
+    EXPECT_EQ(last_read, memoryWord(BASE + CACHE_BYTES + 8));
+}
+
+//a dirty line moves to the victim cache and back without reaching memory
+TEST_F(DcacheVictimTestbench, DirtyLineKeptInVictimCache)
+{
+    access(true, BASE, 0xCAFEF00D);
+    EXPECT_EQ(access(false, BASE + CACHE_BYTES), MISS_CYCLES);
+    EXPECT_EQ(memoryWord(BASE), BASE ^ 0x5A5A0000);
+    EXPECT_EQ(access(false, BASE), SWAP_CYCLES);
+    EXPECT_EQ(last_read, 0xCAFEF00Du);
+}
+
+//the victim cache replaces its entries round robin, only a dirty one it drops is written back
+TEST_F(DcacheVictimTestbench, OldestVictimWrittenBack)
+{
+    access(true, BASE, 0xCAFEF00D);
+    for (uint32_t i = 1; i <= VICTIM_ENTRIES; i++)
+        EXPECT_EQ(access(false, BASE + i * CACHE_BYTES), MISS_CYCLES);
+
+    top->read_en_i = 1;
+    top->addr_i = BASE + (VICTIM_ENTRIES + 1) * CACHE_BYTES;
+    settle();
+    EXPECT_TRUE(top->writeback_o);
+    EXPECT_EQ(access(false, BASE + (VICTIM_ENTRIES + 1) * CACHE_BYTES), WRITEBACK_MISS_CYCLES);
+    EXPECT_EQ(memoryWord(BASE), 0xCAFEF00Du);
+
+    EXPECT_EQ(access(false, BASE), MISS_CYCLES);
+    EXPECT_EQ(last_read, 0xCAFEF00Du);
+    EXPECT_EQ(access(false, BASE + VICTIM_ENTRIES * CACHE_BYTES), SWAP_CYCLES);
+}
+
+//a miss to an empty set moves nothing to the victim cache, the dirty entry it would replace stays
+TEST_F(DcacheVictimTestbench, EmptySetKeepsVictim)
+{
+    access(true, BASE, 0xCAFEF00D);
+    for (uint32_t i = 1; i <= VICTIM_ENTRIES; i++)
+        EXPECT_EQ(access(false, BASE + i * CACHE_BYTES), MISS_CYCLES);
+
+    top->read_en_i = 1;
+    top->addr_i = BASE + LINE_BYTES;
+    settle();
+    EXPECT_FALSE(top->writeback_o);
+    EXPECT_EQ(access(false, BASE + LINE_BYTES), MISS_CYCLES);
+
+    EXPECT_EQ(access(false, BASE), SWAP_CYCLES);
+    EXPECT_EQ(last_read, 0xCAFEF00Du);
+    EXPECT_EQ(memoryWord(BASE), BASE ^ 0x5A5A0000);
+}
+
+//a swap takes its set from the access, whatever prefetch_addr_i says (top drives it from the prefetcher every cycle)
+TEST_F(DcacheVictimTestbench, SwapInOtherSet)
+{
+    const uint32_t line = BASE + 5 * LINE_BYTES;
+    top->prefetch_addr_i = BASE + 9 * LINE_BYTES;
+    load(BASE + 9 * LINE_BYTES);
+    access(true, line, 0xCAFEF00D);
+    EXPECT_EQ(access(false, line + CACHE_BYTES), MISS_CYCLES);
+
+    EXPECT_EQ(access(false, line), SWAP_CYCLES);
+    EXPECT_EQ(last_read, 0xCAFEF00Du);
+    EXPECT_EQ(access(false, line + CACHE_BYTES + 4), SWAP_CYCLES);
+    EXPECT_EQ(last_read, memoryWord(line + CACHE_BYTES + 4));
+    EXPECT_EQ(access(false, line), SWAP_CYCLES);
+    EXPECT_EQ(last_read, 0xCAFEF00Du);
+    EXPECT_EQ(access(false, BASE + 9 * LINE_BYTES), 0u);
+    EXPECT_EQ(last_read, memoryWord(BASE + 9 * LINE_BYTES));
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+#include "base_testbench.h"
+
+//geometry and latency of the default icache parameters
+static const uint32_t CACHE_BYTES = 1024;
+static const uint32_t LINE_BYTES = 16;
+static const uint32_t MEM_LATENCY = 4;
+static const uint32_t MISS_CYCLES = MEM_LATENCY + LINE_BYTES / 4 + 1;
+static const uint32_t BASE = 0xBFC00000;
+
+class IcacheTestbench : public BaseTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk = 0;
+        top->rst = 0;
+        top->addr_i = BASE;
+        top->mem_data_i = 0;
+        settle();
+        //rst rises after the first eval, which only records its value, so the async reset fires
+        top->rst = 1;
+        settle();
+        top->rst = 0;
+        settle();
+    }
+
+    //the backing memory, every word holds a pattern derived from its address
+    static uint32_t memory(uint32_t addr) { return addr ^ 0x5A5A0000; }
+
+    //answers the cache's read of the backing memory, which it only samples at the clock edge
+    void settle()
+    {
+        tick();
+        top->mem_data_i = memory(top->mem_addr_o);
+        tick();
+    }
+
+    void stepClock()
+    {
+        top->clk = 1;
+        tick();
+        top->clk = 0;
+        settle();
+    }
+
+    //clocks until addr hits, returns how many cycles hit_o was low
+    uint32_t fetch(uint32_t addr)
+    {
+        top->addr_i = addr;
+        settle();
+        uint32_t cycles = 0;
+        while (!top->hit_o && cycles < MAX_SIM_CYCLES)
+        {
+            stepClock();
+            cycles++;
+        }
+        return cycles;
+    }
+};
+
+TEST_F(IcacheTestbench, ColdMissRefillsLine)
+{
+    EXPECT_FALSE(top->hit_o);
+    EXPECT_TRUE(top->miss_o);
+    EXPECT_EQ(top->instr_o, 0u);
+
+    EXPECT_EQ(fetch(BASE), MISS_CYCLES);
+    EXPECT_EQ(top->instr_o, memory(BASE));
+    EXPECT_FALSE(top->miss_o);
+
+    //the rest of the line came in with it
+    for (uint32_t offset = 4; offset < LINE_BYTES; offset += 4)
+    {
+        EXPECT_EQ(fetch(BASE + offset), 0u);
+        EXPECT_EQ(top->instr_o, memory(BASE + offset));
+    }
+}
+
+TEST_F(IcacheTestbench, NextLineMisses)
+{
+    fetch(BASE);
+    EXPECT_EQ(fetch(BASE + LINE_BYTES), MISS_CYCLES);
+    EXPECT_EQ(top->instr_o, memory(BASE + LINE_BYTES));
+    EXPECT_EQ(fetch(BASE), 0u);
+}
+
+//direct mapped by default, two addresses a cache size apart share a line
+TEST_F(IcacheTestbench, ConflictEvicts)
+{
+    fetch(BASE);
+    EXPECT_EQ(fetch(BASE + CACHE_BYTES), MISS_CYCLES);
+    EXPECT_EQ(top->instr_o, memory(BASE + CACHE_BYTES));
+    EXPECT_EQ(fetch(BASE), MISS_CYCLES);
+    EXPECT_EQ(top->instr_o, memory(BASE));
+}
+
+//a refill completes when fetch moves on, the new PC is looked up after it
+TEST_F(IcacheTestbench, RedirectDuringRefill)
+{
+    top->addr_i = BASE;
+    stepClock();
+    stepClock();
+    EXPECT_EQ(fetch(BASE + 2 * LINE_BYTES), MISS_CYCLES - 2 + MISS_CYCLES);
+    EXPECT_EQ(top->instr_o, memory(BASE + 2 * LINE_BYTES));
+    EXPECT_EQ(fetch(BASE), 0u);
+}
+
+TEST_F(IcacheTestbench, ResetInvalidates)
+{
+    fetch(BASE);
+    top->rst = 1;
+    settle();
+    top->rst = 0;
+    settle();
+    EXPECT_EQ(fetch(BASE), MISS_CYCLES);
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <map>
+
+#include "base_testbench.h"
+
+//the data section, where the tests put the lines they access
+static const uint32_t BASE = 0x10000;
+
+//Fixture for the units between the memory stage and data_mem (dcache, store_buffer). It models the memory
+//behind the unit's port, answers its reads and applies its writes at the clock edge, and drives one load or
+//store at a time until the unit lets it complete.
+class MemoryPortTestbench : public BaseTestbench
+{
+protected:
+    //a write the unit makes at the next clock edge, to the lanes in mask
+    struct MemoryWrite
+    {
+        bool enable;
+        uint32_t addr;
+        uint32_t data;
+        uint32_t mask = 0xFFFFFFFF;
+    };
+
+    //what the unit's port reads in this cycle and writes at the edge
+    virtual uint32_t memoryRead() const = 0;
+    virtual MemoryWrite memoryWrite() const = 0;
+    //outputs of the cycle a load or store completes in, for the unit's own checks
+    virtual void completing() {}
+
+    //call last in initializeInputs(). The first eval only records rst, so it rises after it for the async
+    //reset to run.
+    void reset()
+    {
+        top->rst = 0;
+        settle();
+        top->rst = 1;
+        settle();
+        top->rst = 0;
+        settle();
+    }
+
+    //the backing memory, words that were never written hold a pattern derived from their address
+    std::map<uint32_t, uint32_t> memory;
+    uint32_t memoryWord(uint32_t addr) const
+    {
+        auto it = memory.find(addr & ~3u);
+        return it == memory.end() ? (addr & ~3u) ^ 0x5A5A0000 : it->second;
+    }
+
+    //answers the unit's read of the backing memory, which it only samples at the clock edge
+    void settle()
+    {
+        tick();
+        top->mem_read_data_i = memoryRead();
+        tick();
+    }
+
+    void stepClock()
+    {
+        MemoryWrite write = memoryWrite();
+        top->clk = 1;
+        tick();
+        if (write.enable)
+            memory[write.addr & ~3u] = (memoryWord(write.addr) & ~write.mask) | (write.data & write.mask);
+        top->clk = 0;
+        settle();
+    }
+
+    void present(bool write, uint32_t addr, uint32_t data = 0, uint8_t type = 0, uint8_t sign = 0)
+    {
+        top->read_en_i = !write;
+        top->write_en_i = write;
+        top->addr_i = addr;
+        top->write_data_i = data;
+        top->mem_type_i = type;
+        top->mem_sign_i = sign;
+        settle();
+    }
+
+    //one load or store, clocked until it completes, returns how many cycles it stalled
+    uint32_t access(bool write, uint32_t addr, uint32_t data = 0, uint8_t type = 0, uint8_t sign = 0)
+    {
+        present(write, addr, data, type, sign);
+        uint32_t cycles = 0;
+        while (top->stall_o && cycles < MAX_SIM_CYCLES)
+        {
+            stepClock();
+            cycles++;
+        }
+        last_read = top->read_data_o;
+        completing();
+        stepClock();
+        top->read_en_i = 0;
+        top->write_en_i = 0;
+        settle();
+        return cycles;
+    }
+
+    uint32_t load(uint32_t addr, uint8_t type = 0, uint8_t sign = 0)
+    {
+        access(false, addr, 0, type, sign);
+        return last_read;
+    }
+
+    uint32_t last_read = 0;
+};
@@ -0,0 +1,155 @@
+#include "base_testbench.h"
+
+//V_prefetcher is the stride scheme with the default table and distance
+static const uint32_t STRIDE_ENTRIES = 16;
+static const uint32_t DISTANCE = 16;
+static const uint32_t PC = 0x100;
+static const uint32_t BASE = 0x10000;
+
+class PrefetcherTestbench : public BaseTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk = 0;
+        top->rst = 0;
+        top->access_i = 0;
+        top->load_i = 0;
+        top->pc_i = 0;
+        top->addr_i = 0;
+        top->ack_i = 0;
+        tick();
+        //the first eval only records rst, the table is cleared when it rises after that
+        top->rst = 1;
+        tick();
+        top->rst = 0;
+        tick();
+    }
+
+    void stepClock()
+    {
+        top->clk = 1;
+        tick();
+        top->clk = 0;
+        tick();
+    }
+
+    //one completed load or store, trained on at the clock edge
+    void access(bool load, uint32_t pc, uint32_t addr)
+    {
+        top->access_i = 1;
+        top->load_i = load;
+        top->pc_i = pc;
+        top->addr_i = addr;
+        stepClock();
+        top->access_i = 0;
+        top->load_i = 0;
+        tick();
+    }
+
+    void ack()
+    {
+        top->ack_i = 1;
+        stepClock();
+        top->ack_i = 0;
+        tick();
+    }
+};
+
+//the first access fills the entry, the second learns the stride and the third confirms it, the fourth prefetches
+TEST_F(PrefetcherTestbench, StrideNeedsToRepeat)
+{
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        access(true, PC, BASE + 4 * i);
+        EXPECT_FALSE(top->prefetch_o);
+    }
+    access(true, PC, BASE + 12);
+    EXPECT_TRUE(top->prefetch_o);
+    EXPECT_EQ(top->prefetch_addr_o, BASE + 12 + 4 * DISTANCE);
+}
+
+//a stride longer than a line, the request goes out on the edge of the fourth access and not a cycle before
+TEST_F(PrefetcherTestbench, FirstRequestOnFourthAccess)
+{
+    const uint32_t stride = 64;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        top->access_i = 1;
+        top->load_i = 1;
+        top->pc_i = PC;
+        top->addr_i = BASE + stride * i;
+        tick();
+        EXPECT_FALSE(top->prefetch_o) << "access " << i + 1;
+        stepClock();
+        EXPECT_EQ(top->prefetch_o, i == 3) << "access " << i + 1;
+        top->access_i = 0;
+        top->load_i = 0;
+        tick();
+    }
+    EXPECT_EQ(top->prefetch_addr_o, BASE + 3 * stride + stride * DISTANCE);
+}
+
+TEST_F(PrefetcherTestbench, NegativeStride)
+{
+    for (uint32_t i = 0; i < 4; i++)
+        access(true, PC, BASE - 8 * i);
+    EXPECT_TRUE(top->prefetch_o);
+    EXPECT_EQ(top->prefetch_addr_o, BASE - 24 - 8 * DISTANCE);
+}
+
+//the request stays up until the cache acks it, a newer one replaces it before that
+TEST_F(PrefetcherTestbench, RequestHeldUntilAck)
+{
+    for (uint32_t i = 0; i < 4; i++)
+        access(true, PC, BASE + 4 * i);
+    stepClock();
+    EXPECT_TRUE(top->prefetch_o);
+    access(true, PC, BASE + 16);
+    EXPECT_EQ(top->prefetch_addr_o, BASE + 16 + 4 * DISTANCE);
+    ack();
+    EXPECT_FALSE(top->prefetch_o);
+}
+
+//a load repeating the same address and a changed stride don't prefetch, the new stride has to repeat again
+TEST_F(PrefetcherTestbench, NoSteadyStride)
+{
+    for (uint32_t i = 0; i < 4; i++)
+        access(true, PC, BASE);
+    EXPECT_FALSE(top->prefetch_o);
+
+    for (uint32_t i = 0; i < 4; i++)
+        access(true, PC + 4, BASE + 4 * i);
+    ack();
+    access(true, PC + 4, BASE + 100);
+    EXPECT_FALSE(top->prefetch_o);
+    access(true, PC + 4, BASE + 200);
+    EXPECT_FALSE(top->prefetch_o);
+    access(true, PC + 4, BASE + 300);
+    EXPECT_FALSE(top->prefetch_o);
+    access(true, PC + 4, BASE + 400);
+    EXPECT_TRUE(top->prefetch_o);
+}
+
+//stores don't train, and a load whose PC maps to the same entry replaces the one there
+TEST_F(PrefetcherTestbench, StoresAndAliasesDontTrain)
+{
+    for (uint32_t i = 0; i < 4; i++)
+        access(false, PC, BASE + 4 * i);
+    EXPECT_FALSE(top->prefetch_o);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        access(true, PC, BASE + 4 * i);
+        access(true, PC + 4 * STRIDE_ENTRIES, BASE + 4 * i);
+    }
+    access(true, PC, BASE + 12);
+    EXPECT_FALSE(top->prefetch_o);
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+#include "memory_port_testbench.h"
+
+//entries of the default store_buffer parameters
+static const uint32_t ENTRIES = 4;
+
+class StoreBufferTestbench : public MemoryPortTestbench
+{
+protected:
+    void initializeInputs() override
+    {
+        top->clk = 0;
+        top->read_en_i = 0;
+        top->write_en_i = 0;
+        top->mem_type_i = 0;
+        top->mem_sign_i = 0;
+        top->addr_i = 0;
+        top->write_data_i = 0;
+        top->drain_i = 0;
+        top->mem_read_data_i = 0;
+        top->mem_stall_i = 0;
+        reset();
+    }
+
+    //the memory side is data_mem_top's byte lanes, mem_stall_i high holds whatever the buffer sends it
+    static uint32_t laneMask(uint8_t type, uint32_t addr)
+    {
+        if (type == 1) return 0xFFu << 8 * (addr & 3);
+        if (type == 2) return 0xFFFFu << 8 * (addr & 2);
+        return 0xFFFFFFFFu;
+    }
+
+    uint32_t memoryRead() const override
+    {
+        uint32_t addr = top->mem_addr_o;
+        uint8_t type = top->mem_type_o;
+        uint32_t value = (memoryWord(addr) & laneMask(type, addr)) >> 8 * (addr & (type == 2 ? 2 : type == 1 ? 3 : 0));
+        if (type == 1 && !top->mem_sign_o) return uint32_t(int32_t(int8_t(value)));
+        if (type == 2 && !top->mem_sign_o) return uint32_t(int32_t(int16_t(value)));
+        return value;
+    }
+
+    MemoryWrite memoryWrite() const override
+    {
+        uint32_t data = top->mem_write_data_o;
+        uint32_t lanes = top->mem_type_o == 1 ? data * 0x01010101u : top->mem_type_o == 2 ? data * 0x00010001u : data;
+        return {top->mem_write_en_o && !top->mem_stall_i, top->mem_addr_o, lanes,
+                laneMask(top->mem_type_o, top->mem_addr_o)};
+    }
+
+    void completing() override { last_forward = top->forward_o; }
+
+    bool last_forward = false;
+};
+
+//a store doesn't wait on memory, it goes in the next cycle the port is free
+TEST_F(StoreBufferTestbench, StoreDrainsWhenPortIsFree)
+{
+    EXPECT_EQ(access(true, BASE, 0xDEADBEEF), 0u);
+    EXPECT_TRUE(top->mem_write_en_o);
+    EXPECT_EQ(memoryWord(BASE), BASE ^ 0x5A5A0000);
+    stepClock();
+    EXPECT_EQ(memoryWord(BASE), 0xDEADBEEFu);
+    EXPECT_FALSE(top->mem_write_en_o);
+}
+
+//a load that doesn't overlap the buffered stores takes the port ahead of them
+TEST_F(StoreBufferTestbench, LoadGoesAheadOfStores)
+{
+    access(true, BASE, 0xDEADBEEF);
+    EXPECT_EQ(access(false, BASE + 4), 0u);
+    EXPECT_EQ(last_read, memoryWord(BASE + 4));
+    EXPECT_FALSE(last_forward);
+    EXPECT_EQ(memoryWord(BASE), BASE ^ 0x5A5A0000);
+    stepClock();
+    EXPECT_EQ(memoryWord(BASE), 0xDEADBEEFu);
+}
+
+//every byte comes from the youngest store that wrote it
+TEST_F(StoreBufferTestbench, ForwardsYoungestBytes)
+{
+    top->mem_stall_i = 1;
+    access(true, BASE, 0x11223344);
+    access(true, BASE + 1, 0xAB, 1);
+    access(true, BASE + 2, 0xCDEF, 2);
+
+    EXPECT_EQ(access(false, BASE), 0u);
+    EXPECT_TRUE(last_forward);
+    EXPECT_EQ(last_read, 0xCDEFAB44u);
+    EXPECT_EQ(load(BASE + 1, 1, 0), 0xFFFFFFABu);
+    EXPECT_EQ(load(BASE + 2, 2, 1), 0xCDEFu);
+    EXPECT_EQ(load(BASE + 3, 1, 1), 0xCDu);
+}
+
+//part of the load is in the buffer and part in memory, it waits for the store to drain
+TEST_F(StoreBufferTestbench, PartialOverlapStalls)
+{
+    top->mem_stall_i = 1;
+    access(true, BASE + 1, 0xAB, 1);
+    present(false, BASE);
+    EXPECT_TRUE(top->stall_o);
+    EXPECT_TRUE(top->buffer_stall_o);
+    EXPECT_FALSE(top->forward_o);
+
+    top->mem_stall_i = 0;
+    EXPECT_EQ(access(false, BASE), 1u);
+    EXPECT_FALSE(last_forward);
+    EXPECT_EQ(last_read, ((BASE ^ 0x5A5A0000) & ~0xFF00u) | 0xAB00u);
+}
+
+//a store into a full buffer waits for its oldest to drain, the stores reach memory in order
+TEST_F(StoreBufferTestbench, FullBufferStalls)
+{
+    top->mem_stall_i = 1;
+    for (uint32_t i = 0; i < ENTRIES; i++)
+        EXPECT_EQ(access(true, BASE, i), 0u);
+    present(true, BASE, ENTRIES);
+    EXPECT_TRUE(top->stall_o);
+    stepClock();
+    EXPECT_TRUE(top->stall_o);
+
+    top->mem_stall_i = 0;
+    settle();
+    EXPECT_FALSE(top->stall_o);
+    stepClock();
+    top->write_en_i = 0;
+    settle();
+    for (uint32_t i = 0; i < ENTRIES; i++)
+        stepClock();
+    EXPECT_EQ(memoryWord(BASE), ENTRIES);
+}
+
+TEST_F(StoreBufferTestbench, DrainWaitsForEmptyBuffer)
+{
+    top->mem_stall_i = 1;
+    access(true, BASE, 0x01234567);
+    access(true, BASE + 4, 0x89ABCDEF);
+    top->drain_i = 1;
+    settle();
+    EXPECT_TRUE(top->stall_o);
+
+    top->mem_stall_i = 0;
+    settle();
+    uint32_t cycles = 0;
+    while (top->stall_o && cycles < MAX_SIM_CYCLES)
+    {
+        stepClock();
+        cycles++;
+    }
+    EXPECT_EQ(cycles, 2u);
+    EXPECT_EQ(memoryWord(BASE), 0x01234567u);
+    EXPECT_EQ(memoryWord(BASE + 4), 0x89ABCDEFu);
+}
+
+int main(int argc, char **argv)
+{
+    Verilated::commandArgs(argc, argv);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <memory>
 #include <utility>
 
 #include "Vdut.h"
@@ -9,6 +10,8 @@
 #include "gtest/gtest.h"
 
 #include "vbuddy.cpp"
+#include "../common/loop_skip.h"
+#include "../common/phase_profile.h"
 
 // f1 lights are visual, so we don't need millions of cycles.
 // 1000 is plenty to watch the sequence loop a few times.
@@ -58,6 +61,7 @@ public:
         top_->clk = 1;
         top_->rst = 1;
         top_->trigger = 0;
+        top_->out_ready = 1;
         
         for(int i=0; i<10; i++) {
             top_->eval(); 
@@ -68,22 +72,37 @@ public:
         }
         
         top_->rst = 0;
+        // the program waits for the start button, press it once (the latch in io_port.sv holds it)
+        top_->trigger = 1;
+
+        // the delay loops only hold the lights, skip them (common/loop_skip.h)
+        skipper_ = std::make_unique<LoopSkipper>(top_);
     }
 
     void runSimulation(int cycles = 1) {
         for (int i = 0; i < cycles; i++) {
-            // cycle the clock
-            for (int clk = 0; clk < 2; clk++) {
-                top_->eval();
-                tfp_->dump(2 * ticks_ + clk);
-                top_->clk = !top_->clk;
+            // the program only writes the output fifo when the lights change,
+            // so vbuddy is only sent real updates. the word is popped at this edge.
+            if (top_->out_valid) {
+                PROFILE_PHASE("vbuddy");
+                // masking with 0xFF ensures we only send the bottom 8 bits (since bar is 8-bit).
+                vbdBar(top_->out_data & 0xFF);
+                vbdCycle(ticks_);
             }
+
+            // cycle the clock
+            //the core is posedge only: the low phase just re-arms the edge, one sample per cycle
+            top_->clk = 0;
+            top_->eval();
+            top_->clk = 1;
+            top_->eval();
+            tfp_->dump(2 * ticks_ + 1);
             ticks_++;
-            
-            // display the value of a0 on the led bar.
-            // masking with 0xFF ensures we only send the bottom 8 bits (since bar is 8-bit).
-            vbdBar(top_->a0 & 0xFF);
-            vbdCycle(i);
+            top_->trigger = 0;
+
+            int skipped = skipper_->trySkip(cycles - i - 1);
+            i += skipped;
+            ticks_ += skipped;
 
             if (Verilated::gotFinish()) {
                 std::cout << "verilog $finish encountered" << std::endl;
@@ -94,6 +113,7 @@ public:
 
     void TearDown() override {
         vbdClose();
+        skipper_.reset();
 
         top_->final();
         tfp_->close();
@@ -116,6 +136,7 @@ protected:
     VerilatedVcdC* tfp_;
     std::string name_;
     unsigned int ticks_;
+    std::unique_ptr<LoopSkipper> skipper_;
 };
 
 int main(int argc, char **argv) {
@@ -134,6 +155,7 @@ int main(int argc, char **argv) {
     std::cout << "simulation finished." << std::endl;
 
     tb.TearDown();
+    reportPhases(std::cout);
 
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <memory>
 #include <utility>
 
 #include "Vdut.h"
@@ -9,17 +10,15 @@
 #include "gtest/gtest.h"
 
 #include "vbuddy.cpp"
+#include "../common/phase_profile.h"
+#include "../common/telemetry.h"
 
 #define PDF_SIM_CYCLES 2000000
+//progress on stderr and in test_out/5_pdf/telemetry.prom while the run is silent
+#define TELEMETRY_INTERVAL 250000
 
-//fast forward thresholds allow us to skip execution on vbuddy to a target
-//in order to speed up uneventful part of simulation with cpu initialising/data is being loaded in
-
-// gaussian
-#define FAST_FORWARD_THRESHOLD 123500
-//noisy #define FAST_FORWARD_THRESHOLD 204700
-//triangle #define FAST_FORWARD_THRESHOLD 317000
-//sine #define FAST_FORWARD_THRESHOLD 38500
+//vbuddy is opened on the first word the display loop streams out (rtl/io_port.sv),
+//so the init and build phases run without touching it whatever the distribution
 
 class PdfTestbench : public ::testing::Test {
 public:
@@ -56,6 +55,7 @@ public:
         top_->clk = 1;
         top_->rst = 1;
         top_->trigger = 0;
+        top_->out_ready = 1;
         
         //run a few reset cycles (using the basic clock loop manually here to avoid triggering plot logic)
         for(int i=0; i<10; i++) {
@@ -67,39 +67,42 @@ public:
         }
         
         top_->rst = 0;
+
+        telemetry_ = std::make_unique<Telemetry>(top_, name_, TELEMETRY_INTERVAL,
+                                                 "test_out/" + name_ + "/telemetry.prom");
+        telemetry_->loadSymbols("test_out/" + name_ + "/program.dis");
     }
 
     void runSimulation(int cycles = 1) {
         bool vbuddy_connected = false;
 
         for (int i = 0; i < cycles; i++) {
-            //standard clocking
-            for (int clk = 0; clk < 2; clk++) {
-                top_->eval();
-                tfp_->dump(2 * ticks_ + clk);
-                top_->clk = !top_->clk;
-            }
-            ticks_++;
-            
-            //check if we just hit the threshold
-            if (ticks_ == FAST_FORWARD_THRESHOLD) {
-                std::cout << "fast forward complete. connecting to vbuddy..." << std::endl;
-                
-                if (vbdOpen() != 1) {
-                    std::cout << "error: failed to open vbuddy" << std::endl;
-                    exit(1);
+            //one bin per output word, popped at this edge
+            if (top_->out_valid) {
+                if (!vbuddy_connected) {
+                    std::cout << "display loop reached at cycle " << ticks_ << ", connecting to vbuddy..." << std::endl;
+                    if (vbdOpen() != 1) {
+                        std::cout << "error: failed to open vbuddy" << std::endl;
+                        exit(1);
+                    }
+                    vbdHeader("pdf program");
+                    vbuddy_connected = true;
                 }
-                vbdHeader("pdf program");
-                vbuddy_connected = true;
+                PROFILE_PHASE("vbuddy");
+                //plot the bin (0-255)
+                vbdPlot(int(top_->out_data), 0, 255);
+                vbdCycle(ticks_);
             }
 
-            //only plot if we are past the threshold and connected
-            if (vbuddy_connected) {
-                //plot a0 (0-255)
-                vbdPlot(int(top_->a0), 0, 255);
-                vbdCycle(i);
-                //std::cout << int(top_->a0) << std::endl;
-            }
+            //standard clocking
+            //the core is posedge only: the low phase just re-arms the edge, one sample per cycle
+            top_->clk = 0;
+            top_->eval();
+            top_->clk = 1;
+            top_->eval();
+            tfp_->dump(2 * ticks_ + 1);
+            ticks_++;
+            telemetry_->sample();
 
             //check for exit
             if (Verilated::gotFinish()) {
@@ -112,6 +115,7 @@ public:
     void TearDown() override {
         //close vbuddy if it was opened
         vbdClose();
+        telemetry_.reset();
 
         top_->final();
         tfp_->close();
@@ -132,6 +136,7 @@ protected:
     VerilatedVcdC* tfp_;
     std::string name_;
     unsigned int ticks_;
+    std::unique_ptr<Telemetry> telemetry_;
 };
 
 int main(int argc, char **argv) {
@@ -145,7 +150,6 @@ int main(int argc, char **argv) {
     tb.initSimulation();
     
     std::cout << "running simulation..." << std::endl;
-    std::cout << "fast forwarding first " << FAST_FORWARD_THRESHOLD << " cycles..." << std::endl;
     
     tb.runSimulation(PDF_SIM_CYCLES);
     
@@ -159,6 +163,7 @@ int main(int argc, char **argv) {
     }
 
     tb.TearDown();
+    reportPhases(std::cout);
 
     return 0;
 }
\ No newline at end of file